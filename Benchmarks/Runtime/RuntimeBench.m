@@ -0,0 +1,411 @@
+//
+//  RuntimeBench.m
+//
+//  Microbenchmarks for the runtime code wsdl2objc generates, built by run.sh
+//  against bindings generated from fixture.wsdl. Reports, per benchmark,
+//  nanoseconds, bytes allocated, allocations and Objective-C objects created
+//  per operation as JSON.
+//
+//  usage: RuntimeBench [-report <path>] [-filter <substring>] [-minTime <seconds>]
+//
+//  Before benchmarking, checks that every truncation of a snapshot is rejected
+//  without reading past the end of the data, and exits 1 if one isn't.
+//
+//  Allocations are counted by hooking the default malloc zone and objects by
+//  hooking +[NSObject allocWithZone:], so CoreFoundation objects created
+//  without +alloc (e.g. most NSStrings made from C strings) show up only as
+//  allocations.
+//
+
+#import <Foundation/Foundation.h>
+#import <libxml/parser.h>
+#import <libxml/tree.h>
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+#import <malloc/malloc.h>
+#import <objc/runtime.h>
+#import <sys/mman.h>
+
+#import "FixtureService.h"
+#import "NSDate+ISO8601Parsing.h"
+#import "NSDate+ISO8601Unparsing.h"
+#import "USAdditions.h"
+#import "USSnapshot.h"
+
+#pragma mark Counters
+
+static uint64_t allocationCount, allocatedBytes, objectCount;
+
+static void *(*realMalloc)(struct _malloc_zone_t *, size_t);
+static void *(*realCalloc)(struct _malloc_zone_t *, size_t, size_t);
+static void *(*realRealloc)(struct _malloc_zone_t *, void *, size_t);
+static id (*realAllocWithZone)(id, SEL, NSZone *);
+
+static void *countingMalloc(struct _malloc_zone_t *zone, size_t size) {
+    ++allocationCount; allocatedBytes += size;
+    return realMalloc(zone, size);
+}
+
+static void *countingCalloc(struct _malloc_zone_t *zone, size_t count, size_t size) {
+    ++allocationCount; allocatedBytes += count * size;
+    return realCalloc(zone, count, size);
+}
+
+static void *countingRealloc(struct _malloc_zone_t *zone, void *ptr, size_t size) {
+    ++allocationCount; allocatedBytes += size;
+    return realRealloc(zone, ptr, size);
+}
+
+static id countingAllocWithZone(id cls, SEL _cmd, NSZone *zone) {
+    ++objectCount;
+    return realAllocWithZone(cls, _cmd, zone);
+}
+
+// The hooks are only in place while counting, so that the timed batches run
+// on the allocator's and the runtime's usual paths
+static void installCounters(void) {
+    malloc_zone_t *zone = malloc_default_zone();
+    vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(*zone), 0, VM_PROT_READ | VM_PROT_WRITE);
+    realMalloc = zone->malloc;
+    realCalloc = zone->calloc;
+    realRealloc = zone->realloc;
+    zone->malloc = countingMalloc;
+    zone->calloc = countingCalloc;
+    zone->realloc = countingRealloc;
+    vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(*zone), 0, VM_PROT_READ);
+
+    // Replacing NSObject's implementation also takes every class off the
+    // runtime's fast allocation path, so [X alloc] and [X new] reach it
+    Method allocWithZone = class_getClassMethod([NSObject class], @selector(allocWithZone:));
+    realAllocWithZone = (id (*)(id, SEL, NSZone *))method_setImplementation(allocWithZone, (IMP)countingAllocWithZone);
+}
+
+static void removeCounters(void) {
+    Method allocWithZone = class_getClassMethod([NSObject class], @selector(allocWithZone:));
+    method_setImplementation(allocWithZone, (IMP)realAllocWithZone);
+
+    malloc_zone_t *zone = malloc_default_zone();
+    vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(*zone), 0, VM_PROT_READ | VM_PROT_WRITE);
+    zone->malloc = realMalloc;
+    zone->calloc = realCalloc;
+    zone->realloc = realRealloc;
+    vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(*zone), 0, VM_PROT_READ);
+}
+
+#pragma mark Harness
+
+static NSMutableDictionary *results;
+static NSString *filter;
+static double minTime;
+
+static double secondsSince(uint64_t start) {
+    static mach_timebase_info_data_t timebase;
+    if (!timebase.denom) mach_timebase_info(&timebase);
+    return (double)(mach_absolute_time() - start) * timebase.numer / timebase.denom / 1e9;
+}
+
+static double timeIterations(uint64_t iterations, void (^body)(void)) {
+    uint64_t start = mach_absolute_time();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        @autoreleasepool { body(); }
+    }
+    return secondsSince(start);
+}
+
+// Times body in batches of at least 10ms until minTime has passed and records
+// the fastest batch, then counts allocations over one more batch
+static void bench(NSString *name, void (^body)(void)) {
+    if (filter && [name rangeOfString:filter].location == NSNotFound) return;
+
+    timeIterations(1, body);
+    uint64_t iterations = 1;
+    while (timeIterations(iterations, body) < 0.01)
+        iterations *= 2;
+
+    double best = INFINITY, total = 0;
+    do {
+        double elapsed = timeIterations(iterations, body);
+        best = MIN(best, elapsed);
+        total += elapsed;
+    } while (total < minTime);
+
+    allocationCount = allocatedBytes = objectCount = 0;
+    installCounters();
+    timeIterations(iterations, body);
+    removeCounters();
+
+    results[name] = @{@"ns_per_op": @(best * 1e9 / iterations),
+                      @"bytes_per_op": @((double)allocatedBytes / iterations),
+                      @"allocations_per_op": @((double)allocationCount / iterations),
+                      @"objects_per_op": @((double)objectCount / iterations),
+                      @"iterations": @(iterations)};
+    fprintf(stderr, "%-48s %12.0f ns/op %12.0f B/op %8.1f objects/op\n", [name UTF8String],
+            best * 1e9 / iterations, (double)allocatedBytes / iterations, (double)objectCount / iterations);
+}
+
+#pragma mark Payloads
+
+static NSString *const envelopeStart =
+    @"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+    "<soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\""
+    " xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xmlns:fx=\"http://example.com/fixture/types\">"
+    "<soap:Body>";
+static NSString *const envelopeEnd = @"</soap:Body></soap:Envelope>";
+
+static NSString *addressXML(NSUInteger i) {
+    return [NSString stringWithFormat:@"<street>%lu Market Street</street><city>San Francisco</city>"
+            "<postalCode>941%02lu</postalCode><country>US</country>", (unsigned long)i, (unsigned long)(i % 100)];
+}
+
+static NSString *lineItemXML(NSUInteger i) {
+    return [NSString stringWithFormat:@"<sku>SKU-%06lu</sku><quantity>%lu</quantity><unitPrice>%lu.99</unitPrice>%@",
+            (unsigned long)i, (unsigned long)(i % 7 + 1), (unsigned long)(i % 90 + 9),
+            i % 3 ? @"" : @"<note>gift wrap</note>"];
+}
+
+static NSString *orderXML(NSUInteger i, BOOL typed) {
+    static NSString *const statuses[] = {@"pending", @"shipped", @"delivered", @"cancelled", @"returned"};
+    NSMutableString *xml = [NSMutableString stringWithFormat:
+        @"<fx:order currency=\"USD\"%@><orderId>%lu</orderId><customer>customer-%lu</customer>"
+        "<status>%@</status><placed>2014-03-%02luT10:%02lu:00Z</placed><shipTo>%@</shipTo>",
+        typed ? @" xsi:type=\"fx:PriorityOrder\"" : @"", (unsigned long)i, (unsigned long)(i % 50),
+        statuses[i % 5], (unsigned long)(i % 28 + 1), (unsigned long)(i % 60), addressXML(i)];
+    for (NSUInteger j = 0; j < 3; ++j)
+        [xml appendFormat:@"<item>%@</item>", lineItemXML(i * 3 + j)];
+    [xml appendString:@"<signature>c2lnbmVkIGJ5IHRoZSBiZW5jaG1hcms=</signature>"];
+    if (typed)
+        [xml appendString:@"<priority>1</priority>"];
+    [xml appendString:@"</fx:order>"];
+    return xml;
+}
+
+static NSData *orderListEnvelope(NSUInteger orders, BOOL typed) {
+    NSMutableString *xml = [NSMutableString stringWithString:envelopeStart];
+    [xml appendFormat:@"<fx:ListOrdersResponse><total>%lu</total>", (unsigned long)orders];
+    for (NSUInteger i = 0; i < orders; ++i)
+        [xml appendString:orderXML(i, typed)];
+    [xml appendString:@"</fx:ListOrdersResponse>"];
+    [xml appendString:envelopeEnd];
+    return [xml dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+static NSData *faultEnvelope(BOOL soap12) {
+    NSString *xml = soap12
+        ? @"<?xml version=\"1.0\"?><soap:Envelope xmlns:soap=\"http://www.w3.org/2003/05/soap-envelope\"><soap:Body>"
+          "<soap:Fault><soap:Code><soap:Value>soap:Receiver</soap:Value></soap:Code>"
+          "<soap:Reason><soap:Text xml:lang=\"en\">Order service unavailable</soap:Text></soap:Reason>"
+          "<soap:Detail><message>try again later</message></soap:Detail></soap:Fault></soap:Body></soap:Envelope>"
+        : @"<?xml version=\"1.0\"?><soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\"><soap:Body>"
+          "<soap:Fault><faultcode>soap:Server</faultcode><faultstring>Order service unavailable</faultstring>"
+          "<detail><message>try again later</message></detail></soap:Fault></soap:Body></soap:Envelope>";
+    return [xml dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+static xmlNodePtr firstElementChild(xmlNodePtr node) {
+    for (xmlNodePtr cur = node ? node->children : NULL; cur; cur = cur->next) {
+        if (cur->type == XML_ELEMENT_NODE) return cur;
+    }
+    return NULL;
+}
+
+static xmlNodePtr bodyChild(xmlDocPtr doc) {
+    return firstElementChild(firstElementChild(xmlDocGetRootElement(doc)));
+}
+
+static xmlDocPtr parse(NSData *data) {
+    return xmlReadMemory([data bytes], (int)[data length], NULL, NULL, XML_PARSE_COMPACT | XML_PARSE_NONET);
+}
+
+#pragma mark Serialization
+
+// Stands in for an operation as the envelope's delegate
+@interface BenchBody : NSObject
+@property (nonatomic, strong) fx_OrderList *list;
+@end
+
+@implementation BenchBody
+- (void)addSoapBody:(xmlNodePtr)root {
+    xmlNodePtr body = xmlNewDocNode(root->doc, root->ns, (const xmlChar *)"Body", NULL);
+    xmlAddChild(root, body);
+    [fx_OrderList serializeToChildOf:body withName:"fx:ListOrdersResponse" value:self.list];
+}
+@end
+
+#pragma mark Benchmarks
+
+static void benchOperations(NSString *size, NSUInteger orders) {
+    NSData *payload = orderListEnvelope(orders, NO);
+    NSData *typedPayload = orderListEnvelope(orders, YES);
+
+    bench([NSString stringWithFormat:@"ListOrders/parse/%@", size], ^{
+        xmlFreeDoc(parse(payload));
+    });
+    bench([NSString stringWithFormat:@"ListOrders/deserialize/%@", size], ^{
+        xmlDocPtr doc = parse(payload);
+        (void)[fx_OrderList deserializeNode:bodyChild(doc)];
+        xmlFreeDoc(doc);
+    });
+    // The same payload with xsi:type on every order, so each goes through classForElement
+    bench([NSString stringWithFormat:@"ListOrders/deserialize+xsiType/%@", size], ^{
+        xmlDocPtr doc = parse(typedPayload);
+        (void)[fx_OrderList deserializeNode:bodyChild(doc)];
+        xmlFreeDoc(doc);
+    });
+
+    BenchBody *body = [BenchBody new];
+    xmlDocPtr doc = parse(payload);
+    body.list = [fx_OrderList deserializeNode:bodyChild(doc)];
+    xmlFreeDoc(doc);
+    bench([NSString stringWithFormat:@"ListOrders/serialize/%@", size], ^{
+        (void)[FixtureService_FixtureBinding_envelope serializedFormUsingDelegate:body];
+    });
+}
+
+static void benchTypes(void) {
+    xmlDocPtr doc = parse(orderListEnvelope(1, NO));
+    xmlNodePtr order = NULL;
+    for (xmlNodePtr cur = bodyChild(doc)->children; cur; cur = cur->next) {
+        if (cur->type == XML_ELEMENT_NODE && !xmlStrcmp(cur->name, (const xmlChar *)"order")) order = cur;
+    }
+    xmlNodePtr address = NULL, item = NULL, status = NULL, placed = NULL;
+    for (xmlNodePtr cur = order->children; cur; cur = cur->next) {
+        if (cur->type != XML_ELEMENT_NODE) continue;
+        if (!xmlStrcmp(cur->name, (const xmlChar *)"shipTo")) address = cur;
+        else if (!xmlStrcmp(cur->name, (const xmlChar *)"item") && !item) item = cur;
+        else if (!xmlStrcmp(cur->name, (const xmlChar *)"status")) status = cur;
+        else if (!xmlStrcmp(cur->name, (const xmlChar *)"placed")) placed = cur;
+    }
+
+    bench(@"Address/deserialize", ^{ (void)[fx_Address deserializeNode:address]; });
+    bench(@"LineItem/deserialize", ^{ (void)[fx_LineItem deserializeNode:item]; });
+    bench(@"Order/deserialize", ^{ (void)[fx_Order deserializeNode:order]; });
+
+    fx_Address *addressValue = [fx_Address deserializeNode:address];
+    fx_LineItem *itemValue = [fx_LineItem deserializeNode:item];
+    fx_Order *orderValue = [fx_Order deserializeNode:order];
+    xmlDocPtr out = xmlNewDoc((const xmlChar *)XML_DEFAULT_VERSION);
+    xmlNodePtr root = xmlNewDocNode(out, NULL, (const xmlChar *)"root", NULL);
+    xmlDocSetRootElement(out, root);
+    void (^serialize)(void (^)(void)) = ^(void (^add)(void)) {
+        add();
+        xmlNodePtr child = root->children;
+        xmlUnlinkNode(child);
+        xmlFreeNode(child);
+    };
+    bench(@"Address/serialize", ^{
+        serialize(^{ [fx_Address serializeToChildOf:root withName:"shipTo" value:addressValue]; });
+    });
+    bench(@"LineItem/serialize", ^{
+        serialize(^{ [fx_LineItem serializeToChildOf:root withName:"item" value:itemValue]; });
+    });
+    bench(@"Order/serialize", ^{
+        serialize(^{ [fx_Order serializeToChildOf:root withName:"order" value:orderValue]; });
+    });
+
+    bench(@"OrderStatus/deserializeNode", ^{ (void)[fx_OrderStatus deserializeNodeRaw:status]; });
+    bench(@"OrderStatus/valueFromString", ^{ (void)[fx_OrderStatus valueFromString:@"cancelled"]; });
+    bench(@"OrderStatus/stringFromValue", ^{ (void)[fx_OrderStatus stringFromValue:fx_OrderStatus_delivered]; });
+
+    bench(@"ISO8601/deserializeNode", ^{ (void)[NSDate deserializeNode:placed]; });
+    bench(@"ISO8601/parse", ^{ (void)[NSDate dateWithISO8601String:@"2014-03-17T10:42:00Z"]; });
+    NSDate *date = [NSDate dateWithISO8601String:@"2014-03-17T10:42:00Z"];
+    bench(@"ISO8601/format", ^{ (void)[date ISO8601DateStringWithTime:YES]; });
+
+    xmlFreeDoc(out);
+    xmlFreeDoc(doc);
+}
+
+static void benchBase64(NSString *size, NSUInteger length) {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    uint8_t *bytes = [data mutableBytes];
+    for (NSUInteger i = 0; i < length; ++i)
+        bytes[i] = (uint8_t)(i * 2654435761u >> 24);
+    NSString *encoded = [data base64Encoding];
+    const char *cString = [encoded UTF8String];
+
+    bench([NSString stringWithFormat:@"base64/encode/%@", size], ^{ (void)[data base64Encoding]; });
+    bench([NSString stringWithFormat:@"base64/decode/%@", size], ^{ (void)[NSData dataWithBase64EncodedString:cString]; });
+}
+
+static void benchFaults(void) {
+    NSData *soap11 = faultEnvelope(NO);
+    NSData *soap12 = faultEnvelope(YES);
+    bench(@"SOAPFault/soap11", ^{
+        xmlDocPtr doc = parse(soap11);
+        (void)[SOAPFault deserializeNode:bodyChild(doc) expectedExceptions:nil];
+        xmlFreeDoc(doc);
+    });
+    bench(@"SOAPFault/soap12", ^{
+        xmlDocPtr doc = parse(soap12);
+        (void)[SOAPFault deserializeNode:bodyChild(doc) expectedExceptions:nil];
+        xmlFreeDoc(doc);
+    });
+}
+
+#pragma mark Checks
+
+// Decodes each truncation of a snapshot from the end of a page followed by an
+// inaccessible one, as a mapped cache file would be, so reading past the end
+// crashes instead of going unnoticed
+static BOOL checkTruncatedSnapshots(void) {
+    xmlDocPtr doc = parse(orderListEnvelope(3, NO));
+    fx_OrderList *list = [fx_OrderList deserializeNode:bodyChild(doc)];
+    xmlFreeDoc(doc);
+    NSData *snapshot = [USSnapshot dataWithRootObject:list ofClass:[fx_OrderList class]];
+
+    size_t pageSize = (size_t)getpagesize();
+    size_t length = ([snapshot length] + pageSize - 1) / pageSize * pageSize;
+    uint8_t *pages = mmap(NULL, length + pageSize, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+    if (pages == MAP_FAILED) return NO;
+    mprotect(pages + length, pageSize, PROT_NONE);
+
+    BOOL ok = YES;
+    for (NSUInteger truncated = 0; truncated <= [snapshot length] && ok; ++truncated) {
+        uint8_t *start = pages + length - truncated;
+        memcpy(start, [snapshot bytes], truncated);
+        NSData *data = [NSData dataWithBytesNoCopy:start length:truncated freeWhenDone:NO];
+        NSError *error;
+        id object = [USSnapshot rootObjectOfClass:[fx_OrderList class] withData:data error:&error];
+        if (truncated == [snapshot length] ? !object : (object || !error)) {
+            fprintf(stderr, "Snapshot truncated to %lu of %lu bytes was %s\n", (unsigned long)truncated,
+                    (unsigned long)[snapshot length], object ? "accepted" : "rejected");
+            ok = NO;
+        }
+    }
+
+    munmap(pages, length + pageSize);
+    return ok;
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+        filter = [defaults stringForKey:@"filter"];
+        minTime = [defaults objectForKey:@"minTime"] ? [defaults doubleForKey:@"minTime"] : 0.5;
+        results = [NSMutableDictionary new];
+
+        // Registers the schema prefixes classForElement resolves xsi:type against
+        [FixtureService class];
+        xmlInitParser();
+        if (!checkTruncatedSnapshots())
+            return 1;
+
+        benchTypes();
+        benchOperations(@"small", 1);
+        benchOperations(@"medium", 100);
+        benchOperations(@"huge", 10000);
+        benchBase64(@"1KB", 1 << 10);
+        benchBase64(@"64KB", 1 << 16);
+        benchBase64(@"1MB", 1 << 20);
+        benchFaults();
+
+        NSDictionary *report = @{@"minTime": @(minTime), @"benchmarks": results};
+        NSData *json = [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:nil];
+        NSString *reportPath = [defaults stringForKey:@"report"];
+        if (reportPath)
+            [json writeToFile:[reportPath stringByExpandingTildeInPath] atomically:YES];
+        else
+            fwrite([json bytes], 1, [json length], stdout);
+    }
+    return 0;
+}
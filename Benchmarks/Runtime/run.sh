@@ -0,0 +1,32 @@
+#!/bin/sh
+
+#  run.sh
+#
+#  Generates bindings from fixture.wsdl with the given wsdl2objc, builds
+#  RuntimeBench.m against them and writes its JSON report: ns, bytes,
+#  allocations and objects per op for each type, operation and payload size.
+#
+#  usage: Benchmarks/Runtime/run.sh <path to wsdl2objc> [results.json]
+#  Extra generator options (e.g. "-scalarNumbers YES") can be passed in
+#  WSDL2OBJC_FLAGS and benchmark options (e.g. "-filter ListOrders
+#  -minTime 2") in RUNTIME_BENCH_FLAGS.
+
+set -e
+
+WSDL2OBJC=${1:?usage: $0 <path to wsdl2objc> [results.json]}
+RESULTS=${2:-runtime-results.json}
+HERE=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/wsdl2objc-runtime.XXXXXX")
+trap 'rm -rf "$WORK"' EXIT
+SDK=$(xcrun --show-sdk-path)
+
+mkdir -p "$WORK/generated"
+"$WSDL2OBJC" -wsdlPath "$HERE/fixture.wsdl" -outPath "$WORK/generated/" $WSDL2OBJC_FLAGS 2>/dev/null
+
+echo "Building RuntimeBench"
+xcrun clang -O2 -fobjc-arc -isysroot "$SDK" -I"$SDK/usr/include/libxml2" -I"$WORK/generated" \
+    "$HERE/RuntimeBench.m" "$WORK"/generated/*.m \
+    -framework Foundation -lxml2 -o "$WORK/RuntimeBench"
+
+"$WORK/RuntimeBench" -report "$RESULTS" $RUNTIME_BENCH_FLAGS
+echo "Wrote $RESULTS"
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Writes a synthetic WSDL and a chain of imported XSDs for benchmarking wsdl2objc.
+
+    make_corpus.py --out DIR [--types N] [--elements N] [--enums N]
+                   [--enum-values N] [--import-depth N] [--operations N]
+
+Types are spread evenly over the schemas in the import chain. Every complex
+type has --elements members, which refer to xsd primitives, enums and
+complex types from the same or a deeper schema, and every fourth type
+extends the previous one. Each operation has its own request and response
+element so that all generated types are reachable from the service.
+"""
+
+import argparse
+import os
+import random
+
+XSD = 'http://www.w3.org/2001/XMLSchema'
+PRIMITIVES = ['string', 'int', 'long', 'boolean', 'double', 'dateTime', 'decimal', 'base64Binary']
+
+
+def ns(level):
+    return 'http://example.com/bench/s%d' % level
+
+
+def write_schema(path, level, depth, types, enums, args, rng):
+    out = ['<?xml version="1.0" encoding="UTF-8"?>',
+           '<xsd:schema xmlns:xsd="%s" targetNamespace="%s"' % (XSD, ns(level)),
+           '            xmlns:s%d="%s"' % (level, ns(level))]
+    for deeper in range(level + 1, depth):
+        out.append('            xmlns:s%d="%s"' % (deeper, ns(deeper)))
+    out.append('            elementFormDefault="qualified">')
+    if level + 1 < depth:
+        out.append('  <xsd:import namespace="%s" schemaLocation="schema%d.xsd"/>' % (ns(level + 1), level + 1))
+
+    for name in enums[level]:
+        out.append('  <xsd:simpleType name="%s">' % name)
+        out.append('    <xsd:restriction base="xsd:string">')
+        for v in range(args.enum_values):
+            out.append('      <xsd:enumeration value="%s_v%d"/>' % (name, v))
+        out.append('    </xsd:restriction>')
+        out.append('  </xsd:simpleType>')
+
+    visible = [(l, t) for l in range(level, depth) for t in types[l]]
+    visible_enums = [(l, e) for l in range(level, depth) for e in enums[l]]
+    previous = None
+    for i, name in enumerate(types[level]):
+        out.append('  <xsd:complexType name="%s">' % name)
+        extends = previous is not None and i % 4 == 3
+        if extends:
+            out.append('    <xsd:complexContent>')
+            out.append('      <xsd:extension base="s%d:%s">' % (level, previous))
+        out.append('    <xsd:sequence>')
+        for e in range(args.elements):
+            kind = rng.random()
+            if kind < 0.2 and visible_enums:
+                l, ref = rng.choice(visible_enums)
+                typ = 's%d:%s' % (l, ref)
+            elif kind < 0.4 and visible:
+                l, ref = rng.choice(visible)
+                if (l, ref) == (level, name):
+                    typ = 'xsd:string'
+                else:
+                    typ = 's%d:%s' % (l, ref)
+            else:
+                typ = 'xsd:' + rng.choice(PRIMITIVES)
+            occurs = ' minOccurs="0" maxOccurs="unbounded"' if rng.random() < 0.15 else ''
+            out.append('      <xsd:element name="field%d" type="%s"%s/>' % (e, typ, occurs))
+        out.append('    </xsd:sequence>')
+        if extends:
+            out.append('      </xsd:extension>')
+            out.append('    </xsd:complexContent>')
+        out.append('    <xsd:attribute name="id" type="xsd:string"/>')
+        out.append('  </xsd:complexType>')
+        previous = name
+
+    if level == 0:
+        for op in range(args.operations):
+            for suffix in ('Request', 'Response'):
+                l, ref = rng.choice(visible) if visible else (None, None)
+                out.append('  <xsd:element name="Op%d%s">' % (op, suffix))
+                out.append('    <xsd:complexType><xsd:sequence>')
+                if ref:
+                    out.append('      <xsd:element name="payload" type="s%d:%s"/>' % (l, ref))
+                out.append('    </xsd:sequence></xsd:complexType>')
+                out.append('  </xsd:element>')
+
+    out.append('</xsd:schema>')
+    with open(path, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+def write_wsdl(path, args):
+    out = ['<?xml version="1.0" encoding="UTF-8"?>',
+           '<wsdl:definitions xmlns:wsdl="http://schemas.xmlsoap.org/wsdl/"',
+           '                  xmlns:soap="http://schemas.xmlsoap.org/wsdl/soap/"',
+           '                  xmlns:xsd="%s"' % XSD,
+           '                  xmlns:s0="%s"' % ns(0),
+           '                  xmlns:tns="http://example.com/bench/wsdl"',
+           '                  targetNamespace="http://example.com/bench/wsdl">',
+           '  <wsdl:types>',
+           '    <xsd:schema targetNamespace="http://example.com/bench/wsdl">',
+           '      <xsd:import namespace="%s" schemaLocation="schema0.xsd"/>' % ns(0),
+           '    </xsd:schema>',
+           '  </wsdl:types>']
+    for op in range(args.operations):
+        for suffix in ('Request', 'Response'):
+            out.append('  <wsdl:message name="Op%d%s"><wsdl:part name="parameters" element="s0:Op%d%s"/></wsdl:message>'
+                       % (op, suffix, op, suffix))
+    out.append('  <wsdl:portType name="BenchPortType">')
+    for op in range(args.operations):
+        out.append('    <wsdl:operation name="Op%d">' % op)
+        out.append('      <wsdl:input message="tns:Op%dRequest"/>' % op)
+        out.append('      <wsdl:output message="tns:Op%dResponse"/>' % op)
+        out.append('    </wsdl:operation>')
+    out.append('  </wsdl:portType>')
+    out.append('  <wsdl:binding name="BenchBinding" type="tns:BenchPortType">')
+    out.append('    <soap:binding style="document" transport="http://schemas.xmlsoap.org/soap/http"/>')
+    for op in range(args.operations):
+        out.append('    <wsdl:operation name="Op%d">' % op)
+        out.append('      <soap:operation soapAction="urn:Op%d"/>' % op)
+        out.append('      <wsdl:input><soap:body use="literal"/></wsdl:input>')
+        out.append('      <wsdl:output><soap:body use="literal"/></wsdl:output>')
+        out.append('    </wsdl:operation>')
+    out.append('  </wsdl:binding>')
+    out.append('  <wsdl:service name="Bench">')
+    out.append('    <wsdl:port name="BenchPort" binding="tns:BenchBinding">')
+    out.append('      <soap:address location="http://localhost:8080/bench"/>')
+    out.append('    </wsdl:port>')
+    out.append('  </wsdl:service>')
+    out.append('</wsdl:definitions>')
+    with open(path, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--out', required=True, help='directory to write bench.wsdl and schema*.xsd to')
+    parser.add_argument('--types', type=int, default=200, help='complex types in total')
+    parser.add_argument('--elements', type=int, default=8, help='sequence elements per complex type')
+    parser.add_argument('--enums', type=int, default=20, help='enumerations in total')
+    parser.add_argument('--enum-values', type=int, default=10, help='values per enumeration')
+    parser.add_argument('--import-depth', type=int, default=3, help='length of the schema import chain')
+    parser.add_argument('--operations', type=int, default=20, help='operations of the service')
+    parser.add_argument('--seed', type=int, default=1, help='random seed, so corpora are reproducible')
+    args = parser.parse_args()
+
+    depth = max(args.import_depth, 1)
+    rng = random.Random(args.seed)
+    types = [['Type%d' % i for i in range(args.types) if i % depth == level] for level in range(depth)]
+    enums = [['Enum%d' % i for i in range(args.enums) if i % depth == level] for level in range(depth)]
+
+    os.makedirs(args.out, exist_ok=True)
+    # Deepest first, so that references only go to schemas which exist
+    for level in reversed(range(depth)):
+        write_schema(os.path.join(args.out, 'schema%d.xsd' % level), level, depth, types, enums, args, rng)
+    write_wsdl(os.path.join(args.out, 'bench.wsdl'), args)
+
+
+if __name__ == '__main__':
+    main()
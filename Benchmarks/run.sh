@@ -0,0 +1,46 @@
+#!/bin/sh
+
+#  run.sh
+#
+#  Generates synthetic corpora of increasing size with make_corpus.py, runs
+#  wsdl2objc over each with -benchmarkReport, and merges the per-run reports
+#  into one JSON file keyed by corpus name.
+#
+#  usage: Benchmarks/run.sh <path to wsdl2objc> [results.json]
+#  Extra generator options (e.g. "-splitTypes YES") can be passed in
+#  WSDL2OBJC_FLAGS.
+
+set -e
+
+WSDL2OBJC=${1:?usage: $0 <path to wsdl2objc> [results.json]}
+RESULTS=${2:-benchmark-results.json}
+HERE=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/wsdl2objc-bench.XXXXXX")
+trap 'rm -rf "$WORK"' EXIT
+
+# name:types:operations:import depth
+for corpus in small:100:10:2 medium:1000:50:4 large:5000:200:8; do
+    IFS=: read name types operations depth <<END
+$corpus
+END
+    python3 "$HERE/make_corpus.py" --out "$WORK/$name" --types "$types" \
+        --operations "$operations" --import-depth "$depth"
+    mkdir -p "$WORK/$name/out"
+
+    echo "Generating $name corpus ($types types, $operations operations)"
+    "$WSDL2OBJC" -wsdlPath "$WORK/$name/bench.wsdl" -outPath "$WORK/$name/out/" \
+        -benchmarkReport "$WORK/$name.json" $WSDL2OBJC_FLAGS 2>/dev/null
+done
+
+python3 - "$WORK" "$RESULTS" <<'END'
+import json, os, sys
+work, results = sys.argv[1:3]
+merged = {}
+for name in ('small', 'medium', 'large'):
+    with open(os.path.join(work, name + '.json')) as f:
+        merged[name] = json.load(f)
+with open(results, 'w') as f:
+    json.dump(merged, f, indent=2, sort_keys=True)
+END
+
+echo "Wrote $RESULTS"
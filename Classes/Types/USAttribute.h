@@ -22,16 +22,19 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USSchema;
 @class USType;
 
-@interface USAttribute : NSObject
+@interface USAttribute : NSObject <USCoding>
 @property (nonatomic, strong) NSString *name;
 @property (nonatomic, strong) NSString *wsdlName;
 @property (nonatomic, strong) NSString *attributeDefault;
 @property (nonatomic, strong) USType *type;
 
 - (NSDictionary *)templateKeyDictionary;
+- (void)collapseProxies:(USType *(^)(USType *))resolve;
 
 + (USAttribute *)attributeWithElement:(NSXMLElement *)el schema:(USSchema *)schema;
 @end
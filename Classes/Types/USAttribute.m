@@ -67,4 +67,23 @@
              @"typeName": self.type.typeName,
              @"default": self.attributeDefault};
 }
+
+- (void)collapseProxies:(USType *(^)(USType *))resolve {
+    if (self.type)
+        self.type = resolve(self.type);
+}
+
++ (NSArray *)codingKeys {
+    return @[@"name", @"wsdlName", @"attributeDefault", @"type"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
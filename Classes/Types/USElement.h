@@ -22,16 +22,28 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USType;
 @class USSchema;
 
-@interface USElement : NSObject
+@interface USElement : NSObject <USCoding>
 @property (nonatomic, strong) NSString *name;
 @property (nonatomic, strong) NSString *wsdlName;
 @property (nonatomic, strong) USType *type;
 @property (nonatomic) BOOL isArray;
+// minOccurs is 0, or this is a member of a substitution group
+@property (nonatomic) BOOL isOptional;
 @property (nonatomic, strong) NSMutableArray *substitutions;
 
 - (NSString *)uname;
+// C type of the property for this element when scalar numbers are enabled,
+// or nil if it's an object
+- (NSString *)scalarTypeName;
+// Scalar properties can't be nil, so optional ones record whether they were
+// set in a separate bit
+- (NSNumber *)tracksPresence;
 + (USElement *)elementWithElement:(NSXMLElement *)el schema:(USSchema *)schema;
+// Replace proxies in the type of this element and its substitutions
+- (void)collapseProxies:(USType *(^)(USType *))resolve;
 @end
@@ -56,7 +56,10 @@
         [schema registerType:element.type];
     }
 
+    // Members of a substitution group are alternatives to each other, so
+    // none of them is guaranteed to be present
     [schema withElementFromElement:el attrName:@"substitutionGroup" call:^(USElement *ele) {
+        element.isOptional = YES;
         [ele.substitutions addObject:element];
     }];
 
@@ -67,8 +70,37 @@
 	return [self.name stringWithCapitalizedFirstCharacter];
 }
 
+- (NSString *)scalarTypeName {
+    return self.isArray ? nil : self.type.scalarTypeName;
+}
+
+- (NSNumber *)tracksPresence {
+    return @([self scalarTypeName] && (self.isOptional || [_substitutions count]));
+}
+
 - (NSMutableArray *)substitutions {
     if (!_substitutions) _substitutions = [NSMutableArray new];
     return _substitutions;
 }
+
+- (void)collapseProxies:(USType *(^)(USType *))resolve {
+    if (self.type)
+        self.type = resolve(self.type);
+    for (USElement *substitution in _substitutions)
+        substitution.type = resolve(substitution.type);
+}
+
++ (NSArray *)codingKeys {
+    return @[@"name", @"wsdlName", @"type", @"isArray", @"isOptional", @"substitutions"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
@@ -41,6 +41,10 @@ static int readMax(NSXMLElement *el) {
     return 1;
 }
 
+static BOOL readOptional(NSXMLElement *el) {
+    return [[[el attributeForName:@"minOccurs"] stringValue] isEqualToString:@"0"];
+}
+
 @implementation USParser (Types)
 #pragma mark Types
 
@@ -53,19 +57,9 @@ static int readMax(NSXMLElement *el) {
     return nil;
 }
 
-- (NSString *)uniqueName:(NSString *)base schema:(USSchema *)schema {
-    if (!schema.types[base])
-        return base;
-    for (int i = 2; ; ++i) {
-        NSString *name = [NSString stringWithFormat:@"%@%d", base, i];
-        if (!schema.types[name])
-            return name;
-    }
-}
-
 #pragma mark - Simple
 - (USType *)parseSimpleType:(NSXMLElement *)el schema:(USSchema *)schema name:(NSString *)name {
-    NSString *typename = [[el attributeForName:@"name"] stringValue] ?: [self uniqueName:name schema:schema];
+    NSString *typename = [[el attributeForName:@"name"] stringValue] ?: [schema uniqueTypeName:name];
     for (NSXMLElement *child in [el childElements]) {
         NSString *localName = [child localName];
         if ([localName isEqualToString:@"restriction"])
@@ -104,7 +98,7 @@ static int readMax(NSXMLElement *el) {
 #pragma mark - Complex
 - (USType *)parseComplexType:(NSXMLElement *)el schema:(USSchema *)schema name:(NSString *)name
 {
-    NSString *typename = [[el attributeForName:@"name"] stringValue] ?: [self uniqueName:name schema:schema];
+    NSString *typename = [[el attributeForName:@"name"] stringValue] ?: [schema uniqueTypeName:name];
     return [self processComplexTypeBody:el schema:schema name:typename base:nil];
 }
 
@@ -217,6 +211,7 @@ static int readMax(NSXMLElement *el) {
 - (USElement *)processSequenceElementElement:(NSXMLElement *)el schema:(USSchema *)schema {
     USElement *seqElement = [USElement new];
     seqElement.isArray = readMax(el) != 1;
+    seqElement.isOptional = readOptional(el);
 
     BOOL isRef = [schema withElementFromElement:el attrName:@"ref" call:^(USElement *element) {
         seqElement.wsdlName = element.wsdlName;
@@ -229,7 +224,7 @@ static int readMax(NSXMLElement *el) {
     seqElement.wsdlName = [[el attributeForName:@"name"] stringValue];
     seqElement.name = [seqElement.wsdlName stringByRemovingIllegalCharacters];
 
-    USProxyType *proxy = [USProxyType alloc];
+    USProxyType *proxy = [[USProxyType alloc] initWithName:[[el attributeForName:@"type"] stringValue]];
     BOOL hasTypeRef = [schema withTypeFromElement:el attrName:@"type" call:^(USType *t) {
         proxy.typeName = t.typeName;
         proxy.type = t;
@@ -0,0 +1,60 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class USSchema;
+
+// The kinds of schema component which can be referenced by qualified name.
+// Each kind has its own symbol space, so e.g. an element and a type can share
+// a name.
+typedef NS_ENUM(NSUInteger, USSymbolKind) {
+    USSymbolKindType,
+    USSymbolKindElement,
+    USSymbolKindAttribute,
+    USSymbolKindAttributeGroup,
+    USSymbolKindMessage,
+    USSymbolKindPortType,
+    USSymbolKindBinding,
+    USSymbolKindCount
+};
+
+// An interned qualified name. Each schema hands out exactly one instance per
+// local name, so names can be compared by pointer. A symbol holds whatever
+// has been registered under its name for each kind, along with the fixups
+// still waiting for a definition which hasn't been parsed yet.
+@interface USQName : NSObject
+@property (nonatomic, unsafe_unretained, readonly) USSchema *schema;   // the schema owns its symbols
+@property (nonatomic, copy, readonly) NSString *localName;
+
+- (id)initWithSchema:(USSchema *)schema localName:(NSString *)localName;
+
+- (id)definitionOfKind:(USSymbolKind)kind;
+// Calls the block with the definition now if there is one, and otherwise
+// when it is defined
+- (void)withDefinitionOfKind:(USSymbolKind)kind call:(void (^)(id))block;
+// Sets the definition and runs any pending fixups for it
+- (void)define:(id)value kind:(USSymbolKind)kind;
+// YES if some reference to this name has never been defined
+- (BOOL)hasPendingFixups;
+- (NSUInteger)pendingFixupCountOfKind:(USSymbolKind)kind;
+@end
@@ -0,0 +1,88 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "USQName.h"
+
+#import "USProfiler.h"
+#import "USSchema.h"
+
+@implementation USQName {
+    __strong id _definitions[USSymbolKindCount];
+    NSMutableArray *_fixups[USSymbolKindCount];
+}
+
+- (id)initWithSchema:(USSchema *)schema localName:(NSString *)localName {
+    if ((self = [super init])) {
+        _schema = schema;
+        _localName = [localName copy];
+    }
+    return self;
+}
+
+- (id)definitionOfKind:(USSymbolKind)kind {
+    return _definitions[kind];
+}
+
+- (void)withDefinitionOfKind:(USSymbolKind)kind call:(void (^)(id))block {
+    id value = _definitions[kind];
+    if (value) {
+        block(value);
+        return;
+    }
+
+    uint64_t start = USProfilerBegin(USProfilerPhaseWaitResolution);
+    if (!_fixups[kind])
+        _fixups[kind] = [NSMutableArray new];
+    [_fixups[kind] addObject:block];
+    USProfilerEnd(USProfilerPhaseWaitResolution, start);
+}
+
+- (void)define:(id)value kind:(USSymbolKind)kind {
+    _definitions[kind] = value;
+
+    NSArray *fixups = _fixups[kind];
+    if (!fixups) return;
+
+    uint64_t start = USProfilerBegin(USProfilerPhaseWaitResolution);
+    _fixups[kind] = nil;
+    for (void (^block)(id) in fixups)
+        block(value);
+    USProfilerEnd(USProfilerPhaseWaitResolution, start);
+}
+
+- (BOOL)hasPendingFixups {
+    for (NSUInteger kind = 0; kind < USSymbolKindCount; ++kind) {
+        if ([_fixups[kind] count])
+            return YES;
+    }
+    return NO;
+}
+
+- (NSUInteger)pendingFixupCountOfKind:(USSymbolKind)kind {
+    return [_fixups[kind] count];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"{%@}%@", [self.schema fullName], self.localName];
+}
+
+@end
@@ -22,6 +22,8 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USObjCKeywords;
 @class USWSDL;
 @class USType;
@@ -31,8 +33,9 @@
 @class USPortType;
 @class USBinding;
 @class USService;
+@class USQName;
 
-@interface USSchema : NSObject
+@interface USSchema : NSObject <USCoding>
 @property (nonatomic, copy) NSString *prefix;			// unique global schema prefix (after all includes)
 @property (nonatomic, copy) NSString *fullName;
 @property (nonatomic, strong) NSMutableDictionary *types;
@@ -45,10 +48,16 @@
 @property (nonatomic, strong) NSMutableDictionary *bindings;
 @property (nonatomic, strong) NSMutableDictionary *services;
 @property (nonatomic, strong) USWSDL *wsdl;
-@property (nonatomic) BOOL hasBeenWritten;
 
 - (id)initWithWSDL:(USWSDL *)aWsdl;
 
+// The interned name for a local name in this schema's namespace
+- (USQName *)symbolForLocalName:(NSString *)localName;
+// Names which have been referenced but never defined
+- (NSArray *)unresolvedSymbols;
+// The base name, or the base name with the lowest unused numeric suffix
+- (NSString *)uniqueTypeName:(NSString *)base;
+
 - (BOOL)withTypeFromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(USType *))block;
 - (void)registerType:(USType *)type;
 
@@ -72,8 +81,6 @@
 
 - (void)registerService:(USService *)attribute;
 
-- (void)addSimpleClassWithName:(NSString *)aName representationClass:(NSString *)aClass;
-
 - (BOOL)shouldWrite;
 
 - (NSString *)templateFileHPath;
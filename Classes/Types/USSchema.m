@@ -30,18 +30,14 @@
 #import "USMessage.h"
 #import "USObjCKeywords.h"
 #import "USPortType.h"
+#import "USQName.h"
 #import "USService.h"
 #import "USType.h"
 #import "USWSDL.h"
 
 @interface USSchema ()
-@property (nonatomic, strong) NSMutableDictionary *attributeWaits;
-@property (nonatomic, strong) NSMutableDictionary *attributeGroupWaits;
-@property (nonatomic, strong) NSMutableDictionary *elementWaits;
-@property (nonatomic, strong) NSMutableDictionary *typeWaits;
-@property (nonatomic, strong) NSMutableDictionary *messageWaits;
-@property (nonatomic, strong) NSMutableDictionary *portTypeWaits;
-@property (nonatomic, strong) NSMutableDictionary *bindingWaits;
+@property (nonatomic, strong) NSMutableDictionary *symbols;
+@property (nonatomic, strong) NSMutableDictionary *uniqueNameCounters;
 @end
 
 @implementation USSchema
@@ -59,17 +55,45 @@
         self.services = [NSMutableDictionary new];
         self.wsdl = aWsdl;
 
-        self.attributeWaits = [NSMutableDictionary new];
-        self.attributeGroupWaits = [NSMutableDictionary new];
-        self.elementWaits = [NSMutableDictionary new];
-        self.typeWaits = [NSMutableDictionary new];
-        self.messageWaits = [NSMutableDictionary new];
-        self.portTypeWaits = [NSMutableDictionary new];
-        self.bindingWaits = [NSMutableDictionary new];
+        self.symbols = [NSMutableDictionary new];
+        self.uniqueNameCounters = [NSMutableDictionary new];
     }
     return self;
 }
 
+- (USQName *)symbolForLocalName:(NSString *)localName {
+    USQName *symbol = self.symbols[localName];
+    if (!symbol) {
+        symbol = [[USQName alloc] initWithSchema:self localName:localName];
+        self.symbols[localName] = symbol;
+    }
+    return symbol;
+}
+
+- (NSArray *)unresolvedSymbols {
+    NSMutableArray *unresolved = [NSMutableArray new];
+    for (USQName *symbol in [self.symbols objectEnumerator]) {
+        if ([symbol hasPendingFixups])
+            [unresolved addObject:symbol];
+    }
+    return unresolved;
+}
+
+- (NSString *)uniqueTypeName:(NSString *)base {
+    if (!self.types[base])
+        return base;
+
+    // Resume from the last suffix handed out for this base rather than
+    // probing from 2 each time; still skip any explicitly named types
+    int i = [self.uniqueNameCounters[base] intValue] ?: 2;
+    NSString *name;
+    do {
+        name = [NSString stringWithFormat:@"%@%d", base, i++];
+    } while (self.types[name]);
+    self.uniqueNameCounters[base] = @(i);
+    return name;
+}
+
 - (USSchema *)schemaFromNode:(NSXMLNode *)node element:(NSXMLElement *)el {
     if (!node) return nil;
     NSString *qName = [node stringValue];
@@ -77,142 +101,85 @@
     return self.wsdl.schemas[namespaceURI];
 }
 
-- (BOOL)call:(void (^)(id))block
-withValueForKey:(NSXMLNode *)node
-     ifKeyIn:(NSMutableDictionary *)items
-otherwiseEnqueueIn:(NSMutableDictionary *)waits
-{
-    if (!node) return NO;
+- (BOOL)withSymbolOfKind:(USSymbolKind)kind fromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(id))block {
+    NSXMLNode *node = [el attributeForName:attrName];
+    USSchema *targetSchema = [self schemaFromNode:node element:el];
+    if (!targetSchema) return NO;
 
     NSString *localName = [NSXMLNode localNameForName:[node stringValue]];
-    id value = items[localName];
-    if (value)
-        block(value);
-    else {
-        if (!waits[localName])
-            waits[localName] = [NSMutableArray new];
-        [waits[localName] addObject:block];
-    }
-
+    [[targetSchema symbolForLocalName:localName] withDefinitionOfKind:kind call:block];
     return YES;
 }
 
-- (void)checkWaits:(NSMutableDictionary *)dictionary key:(NSString *)key value:(id)value {
-    if (dictionary[key]) {
-        for (void (^block)(id) in dictionary[key])
-            block(value);
-        [dictionary removeObjectForKey:key];
-    }
-}
-
 - (BOOL)withTypeFromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(USType *))block {
-    NSXMLNode *node = [el attributeForName:attrName];
-    USSchema *targetSchema = [self schemaFromNode:node element:el];
-    return [targetSchema call:block
-              withValueForKey:node
-                      ifKeyIn:targetSchema.types
-           otherwiseEnqueueIn:targetSchema.typeWaits];
+    return [self withSymbolOfKind:USSymbolKindType fromElement:el attrName:attrName call:block];
 }
 
 - (void)registerType:(USType *)type {
     self.types[type.typeName] = type;
-    [self checkWaits:self.typeWaits key:type.typeName value:type];
+    [[self symbolForLocalName:type.typeName] define:type kind:USSymbolKindType];
 }
 
 - (BOOL)withElementFromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(USElement *))block {
-    NSXMLNode *node = [el attributeForName:attrName];
-    USSchema *targetSchema = [self schemaFromNode:node element:el];
-    return [targetSchema call:block
-              withValueForKey:node
-                      ifKeyIn:targetSchema.elements
-           otherwiseEnqueueIn:targetSchema.elementWaits];
+    return [self withSymbolOfKind:USSymbolKindElement fromElement:el attrName:attrName call:block];
 }
 
 - (void)registerElement:(USElement *)element {
     self.elements[element.wsdlName] = element;
-    [self checkWaits:self.elementWaits key:element.wsdlName value:element];
+    [[self symbolForLocalName:element.wsdlName] define:element kind:USSymbolKindElement];
 }
 
 - (BOOL)withAttributeFromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(USAttribute *))block
 {
-    NSXMLNode *node = [el attributeForName:attrName];
-    USSchema *targetSchema = [self schemaFromNode:node element:el];
-    return [targetSchema call:block
-              withValueForKey:node
-                      ifKeyIn:targetSchema.attributes
-           otherwiseEnqueueIn:targetSchema.attributeWaits];
+    return [self withSymbolOfKind:USSymbolKindAttribute fromElement:el attrName:attrName call:block];
 }
 
 - (void)registerAttribute:(USAttribute *)attribute {
     self.attributes[attribute.name] = attribute;
-    [self checkWaits:self.attributeWaits key:attribute.name value:attribute];
+    [[self symbolForLocalName:attribute.name] define:attribute kind:USSymbolKindAttribute];
 }
 
 - (BOOL)withAttributeGroupFromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(NSArray *))block
 {
-    NSXMLNode *node = [el attributeForName:attrName];
-    USSchema *targetSchema = [self schemaFromNode:node element:el];
-    return [targetSchema call:block
-              withValueForKey:node
-                      ifKeyIn:targetSchema.attributeGroups
-           otherwiseEnqueueIn:targetSchema.attributeGroupWaits];
+    return [self withSymbolOfKind:USSymbolKindAttributeGroup fromElement:el attrName:attrName call:block];
 }
 
 - (void)registerAttributeGroup:(NSArray *)group named:(NSString *)name {
     self.attributeGroups[name] = group;
-    [self checkWaits:self.attributeGroupWaits key:name value:group];
+    [[self symbolForLocalName:name] define:group kind:USSymbolKindAttributeGroup];
 }
 
 - (BOOL)withMessageFromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(USMessage *))block {
-    NSXMLNode *node = [el attributeForName:attrName];
-    USSchema *targetSchema = [self schemaFromNode:node element:el];
-    return [targetSchema call:block
-              withValueForKey:node
-                      ifKeyIn:targetSchema.messages
-           otherwiseEnqueueIn:targetSchema.messageWaits];
+    return [self withSymbolOfKind:USSymbolKindMessage fromElement:el attrName:attrName call:block];
 }
 
 - (void)registerMessage:(USMessage *)message {
     self.messages[message.name] = message;
-    [self checkWaits:self.messageWaits key:message.name value:message];
+    [[self symbolForLocalName:message.name] define:message kind:USSymbolKindMessage];
 }
 
 - (BOOL)withPortTypeFromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(USPortType *))block {
-    NSXMLNode *node = [el attributeForName:attrName];
-    USSchema *targetSchema = [self schemaFromNode:node element:el];
-    return [targetSchema call:block
-              withValueForKey:node
-                      ifKeyIn:targetSchema.portTypes
-           otherwiseEnqueueIn:targetSchema.portTypeWaits];
+    return [self withSymbolOfKind:USSymbolKindPortType fromElement:el attrName:attrName call:block];
 }
 
 - (void)registerPortType:(USPortType *)portType {
     self.portTypes[portType.name] = portType;
-    [self checkWaits:self.portTypeWaits key:portType.name value:portType];
+    [[self symbolForLocalName:portType.name] define:portType kind:USSymbolKindPortType];
 }
 
 - (BOOL)withBindingFromElement:(NSXMLElement *)el attrName:(NSString *)attrName call:(void (^)(USBinding *))block {
-    NSXMLNode *node = [el attributeForName:attrName];
-    USSchema *targetSchema = [self schemaFromNode:node element:el];
-    return [targetSchema call:block
-              withValueForKey:node
-                      ifKeyIn:targetSchema.bindings
-           otherwiseEnqueueIn:targetSchema.bindingWaits];
+    return [self withSymbolOfKind:USSymbolKindBinding fromElement:el attrName:attrName call:block];
 }
 
 - (void)registerBinding:(USBinding *)binding {
     self.bindings[binding.name] = binding;
-    [self checkWaits:self.bindingWaits key:binding.name value:binding];
+    [[self symbolForLocalName:binding.name] define:binding kind:USSymbolKindBinding];
 }
 
 - (void)registerService:(USService *)service {
     self.services[service.name] = service;
 }
 
-- (void)addSimpleClassWithName:(NSString *)name representationClass:(NSString *)repClass {
-    self.types[name] = [USType primitiveTypeWithName:name prefix:self.prefix type:repClass];
-}
-
 - (BOOL)shouldWrite {
     return [self.elements count]
         || [self.imports count]
@@ -239,4 +206,18 @@ otherwiseEnqueueIn:(NSMutableDictionary *)waits
              @"wsdl": self.wsdl};
 }
 
+
++ (NSArray *)codingKeys {
+    return @[@"prefix", @"fullName", @"types", @"elements", @"attributes", @"attributeGroups", @"imports", @"messages", @"portTypes", @"bindings", @"services", @"wsdl"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [self initWithWSDL:nil]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
@@ -22,11 +22,13 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USWSDL;
 @class USSchema;
 @class USComplexType;
 
-@interface USType : NSObject
+@interface USType : NSObject <USCoding>
 + (instancetype)primitiveTypeWithName:(NSString *)name prefix:(NSString *)prefix type:(NSString *)type;
 + (instancetype)enumTypeWithName:(NSString *)name prefix:(NSString *)prefix values:(NSArray *)values;
 + (instancetype)arrayTypeWithName:(NSString *)name prefix:(NSString *)prefix choices:(NSArray *)choices;
@@ -36,7 +38,6 @@
 
 @property (nonatomic, readonly) NSString *typeName;
 @property (nonatomic, readonly) NSString *prefix;
-@property (nonatomic) BOOL hasBeenWritten;
 
 @property (nonatomic, readonly) NSNumber *isEnum;
 
@@ -47,13 +48,20 @@
 @property (nonatomic, readonly) NSString *factoryClassName;
 // Name of type for variables which are instances of this type
 @property (nonatomic, readonly) NSString *variableTypeName;
+// C type for properties of this type when the scalarNumbers user default is
+// set, or nil if values of this type are always objects
+@property (nonatomic, readonly) NSString *scalarTypeName;
 
 - (NSString *)templateFileHPath;
 - (NSString *)templateFileMPath;
 - (NSMutableDictionary *)templateKeyDictionary;
 
 - (USComplexType *)asComplex;
+// Types whose generated classes are used by this type's generated code
+- (NSArray *)referencedTypes;
 - (instancetype)deriveWithName:(NSString *)newTypeName prefix:(NSString *)newTypePrefix;
+// Replace each USProxyType this type refers to with resolve(proxy)
+- (void)collapseProxies:(USType *(^)(USType *))resolve;
 @end
 
 @interface USComplexType : USType
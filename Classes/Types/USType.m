@@ -24,6 +24,7 @@
 
 #import "NSBundle+USAdditions.h"
 #import "NSString+USAdditions.h"
+#import "USAttribute.h"
 #import "USElement.h"
 #import "USSchema.h"
 #import "USWSDL.h"
@@ -38,23 +39,154 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
     return ret;
 }
 
+// Numbers the choices from 1 so generated code can switch on a choice's position
+static NSArray *choiceCases(NSArray *choices) {
+    NSMutableArray *ret = [NSMutableArray arrayWithCapacity:choices.count];
+    [choices enumerateObjectsUsingBlock:^(USElement *element, NSUInteger i, BOOL *stop) {
+        [ret addObject:@{@"tag": @(i + 1), @"element": element}];
+    }];
+    return ret;
+}
+
+// Groups a type's attributes and its ancestors' by the first byte of their
+// names, so generated code can switch on that before comparing whole names
+static NSArray *attributeDispatch(USComplexType *type) {
+    NSMutableArray *chain = [NSMutableArray new];
+    for (USComplexType *t = type; t; t = t.superClass.asComplex)
+        [chain insertObject:t atIndex:0];
+
+    NSMutableDictionary *byName = [NSMutableDictionary new];
+    NSMutableArray *names = [NSMutableArray new];
+    for (USComplexType *t in chain) {
+        for (USAttribute *attribute in t.attributes) {
+            if (!byName[attribute.wsdlName])
+                [names addObject:attribute.wsdlName];
+            byName[attribute.wsdlName] = attribute;
+        }
+    }
+
+    NSMutableArray *ret = [NSMutableArray new];
+    NSMutableDictionary *groups = [NSMutableDictionary new];
+    for (NSString *name in names) {
+        unsigned char initial = (unsigned char)[name UTF8String][0];
+        NSMutableArray *group = groups[@(initial)];
+        if (!group) {
+            group = [NSMutableArray new];
+            groups[@(initial)] = group;
+            NSString *label = isalnum(initial) || initial == '_'
+                ? [NSString stringWithFormat:@"'%c'", initial]
+                : [NSString stringWithFormat:@"%d", initial];
+            [ret addObject:@{@"label": label, @"attributes": group}];
+        }
+        [group addObject:byName[name]];
+    }
+    return ret;
+}
+
+static NSArray *typesOfElements(NSArray *elements) {
+    NSMutableArray *ret = [NSMutableArray arrayWithCapacity:elements.count];
+    for (USElement *element in elements) {
+        if (element.type)
+            [ret addObject:element.type];
+    }
+    return ret;
+}
+
 @interface USType ()
 @property (nonatomic, strong) NSString *typeName;
 @property (nonatomic, strong) NSString *prefix;
 
 - (id)initWithName:(NSString *)name prefix:(NSString *)prefix;
+// The generated binary snapshot layout of this type alone, not of the types it refers to
+- (NSString *)snapshotSignature;
+- (NSString *)snapshotFingerprint;
+// The above, computed once per type, since every type's fingerprint covers the
+// signatures of all the types it refers to
+- (NSString *)memoizedSnapshotSignature;
+- (NSString *)memoizedSnapshotFingerprint;
 @end
 
+static void appendSnapshotSignatures(USType *type, NSMutableString *signatures, NSMutableSet *visited) {
+    if (!type || [visited containsObject:type.className]) return;
+    [visited addObject:type.className];
+    [signatures appendFormat:@"%@\n", [type memoizedSnapshotSignature]];
+    for (USType *referenced in [type referencedTypes])
+        appendSnapshotSignatures(referenced, signatures, visited);
+}
+
+static NSString *choicesSnapshotSignature(NSArray *choices) {
+    NSMutableArray *ret = [NSMutableArray arrayWithCapacity:choices.count];
+    for (USElement *element in choices)
+        [ret addObject:[NSString stringWithFormat:@"%@:%@%@", element.wsdlName, element.type.className, element.isArray ? @"[]" : @""]];
+    return [ret componentsJoinedByString:@","];
+}
+
+// How the generated encodeSnapshotFields: and decodeSnapshotFields: read and write one member
+static NSDictionary *snapshotField(NSUInteger tag, NSString *name, NSString *uname, USType *type,
+                                   NSString *scalarTypeName, BOOL tracksPresence)
+{
+    NSMutableDictionary *field = [@{@"tag": @(tag),
+                                    @"name": name,
+                                    @"kind": @"value",
+                                    @"decoder": @"[reader readValue]",
+                                    @"tracksPresence": @(tracksPresence)} mutableCopy];
+    if (uname)
+        field[@"uname"] = uname;
+    if ([scalarTypeName isEqualToString:@"double"]) {
+        field[@"kind"] = @"real";
+        field[@"decoder"] = @"[reader readReal]";
+    }
+    else if (scalarTypeName) {
+        field[@"kind"] = @"integer";
+        field[@"decoder"] = [NSString stringWithFormat:@"(%@)[reader readInteger]", scalarTypeName];
+    }
+    else if ([type.isEnum boolValue]) {
+        field[@"kind"] = @"integer";
+        field[@"decoder"] = [NSString stringWithFormat:@"(%@)[reader readInteger]", type.variableTypeName];
+    }
+    return field;
+}
+
+// Numeric and boolean xsd primitives which can be stored unboxed
+static NSString *scalarTypeForPrimitive(NSString *typeName) {
+    static NSDictionary *scalarTypes;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        scalarTypes = @{@"boolean": @"BOOL",
+                        @"byte": @"int32_t",
+                        @"short": @"int32_t",
+                        @"int": @"int32_t",
+                        @"unsignedByte": @"int32_t",
+                        @"unsignedShort": @"int32_t",
+                        @"unsignedInt": @"int64_t",
+                        @"long": @"int64_t",
+                        @"integer": @"int64_t",
+                        @"nonNegativeInteger": @"int64_t",
+                        @"positiveInteger": @"int64_t",
+                        @"unsignedLong": @"uint64_t",
+                        @"float": @"double",
+                        @"double": @"double"};
+    });
+    return scalarTypes[typeName];
+}
+
 @interface USPrimitiveType : USType
 @property (nonatomic, copy) NSString *representationType;
+// The primitive this type was (possibly indirectly) derived from, whose
+// class implements this type; nil for primitives which aren't derived
+@property (nonatomic, strong) USType *baseType;
 @end
 
 @implementation USPrimitiveType
 - (NSString *)templateFileHPath {
+    if (self.baseType)
+        return [[NSBundle mainBundle] pathForTemplateNamed:@"DerivedPrimitiveType_H"];
     return [[NSBundle mainBundle] pathForTemplateNamed:@"PrimitiveType_H"];
 }
 
 - (NSString *)templateFileMPath {
+    if (self.baseType)
+        return [[NSBundle mainBundle] pathForTemplateNamed:@"DerivedPrimitiveType_M"];
     return [[NSBundle mainBundle] pathForTemplateNamed:@"PrimitiveType_M"];
 }
 
@@ -62,8 +194,41 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
     return self.representationType;
 }
 
+- (NSString *)scalarTypeName {
+    if (![[NSUserDefaults standardUserDefaults] boolForKey:@"scalarNumbers"]) return nil;
+    if (![self.representationType isEqualToString:@"NSNumber *"]) return nil;
+    return scalarTypeForPrimitive((self.baseType ?: self).typeName);
+}
+
+// Primitive values are snapshotted by their Foundation class
+- (NSString *)snapshotFingerprint {
+    return nil;
+}
+
+- (NSMutableDictionary *)templateKeyDictionary {
+    NSMutableDictionary *ret = [super templateKeyDictionary];
+    if (self.baseType)
+        ret[@"baseType"] = self.baseType;
+    return ret;
+}
+
+- (NSArray *)referencedTypes {
+    return self.baseType ? @[self.baseType] : @[];
+}
+
 - (instancetype)deriveWithName:(NSString *)newTypeName prefix:(NSString *)newTypePrefix {
-    return [USPrimitiveType primitiveTypeWithName:newTypeName prefix:newTypePrefix type:self.representationType];
+    USPrimitiveType *type = [USPrimitiveType primitiveTypeWithName:newTypeName prefix:newTypePrefix type:self.representationType];
+    type.baseType = self.baseType ?: self;
+    return type;
+}
+
+- (void)collapseProxies:(USType *(^)(USType *))resolve {
+    if (self.baseType)
+        self.baseType = resolve(self.baseType);
+}
+
++ (NSArray *)codingKeys {
+    return [[super codingKeys] arrayByAddingObjectsFromArray:@[@"representationType", @"baseType"]];
 }
 @end
 
@@ -105,6 +270,14 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
 - (instancetype)deriveWithName:(NSString *)newTypeName prefix:(NSString *)newTypePrefix {
     return [USEnumType enumTypeWithName:newTypeName prefix:newTypePrefix values:self.enumValues];
 }
+
+- (NSString *)snapshotSignature {
+    return [NSString stringWithFormat:@"%@ {%@}", [super snapshotSignature], [self.enumValues componentsJoinedByString:@","]];
+}
+
++ (NSArray *)codingKeys {
+    return [[super codingKeys] arrayByAddingObjectsFromArray:@[@"enumValues"]];
+}
 @end
 
 @interface USArrayType : USType
@@ -128,14 +301,32 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
     NSMutableDictionary *ret = [super templateKeyDictionary];
     NSArray *choices = flattedSubstitutions(self.choices);
     ret[@"choices"] = choices;
+    ret[@"choiceCases"] = choiceCases(choices);
     if (choices.count == 1)
         ret[@"onlyChoice"] = choices.firstObject;
     return ret;
 }
 
+- (NSArray *)referencedTypes {
+    return typesOfElements(flattedSubstitutions(self.choices));
+}
+
 - (instancetype)deriveWithName:(NSString *)newTypeName prefix:(NSString *)newTypePrefix {
     return [USArrayType arrayTypeWithName:newTypeName prefix:newTypePrefix choices:self.choices];
 }
+
+- (NSString *)snapshotSignature {
+    return [NSString stringWithFormat:@"%@ (%@)", [super snapshotSignature], choicesSnapshotSignature(flattedSubstitutions(self.choices))];
+}
+
+- (void)collapseProxies:(USType *(^)(USType *))resolve {
+    for (USElement *element in self.choices)
+        [element collapseProxies:resolve];
+}
+
++ (NSArray *)codingKeys {
+    return [[super codingKeys] arrayByAddingObjectsFromArray:@[@"choices"]];
+}
 @end
 
 @interface USChoiceType : USType
@@ -158,12 +349,30 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
 - (NSMutableDictionary *)templateKeyDictionary {
     NSMutableDictionary *ret = [super templateKeyDictionary];
     ret[@"choices"] = flattedSubstitutions(self.choices);
+    ret[@"choiceCases"] = choiceCases(ret[@"choices"]);
     return ret;
 }
 
+- (NSArray *)referencedTypes {
+    return typesOfElements(flattedSubstitutions(self.choices));
+}
+
 - (instancetype)deriveWithName:(NSString *)newTypeName prefix:(NSString *)newTypePrefix {
     return [USChoiceType choiceTypeWithName:newTypeName prefix:newTypePrefix choices:self.choices];
 }
+
+- (NSString *)snapshotSignature {
+    return [NSString stringWithFormat:@"%@ (%@)", [super snapshotSignature], choicesSnapshotSignature(flattedSubstitutions(self.choices))];
+}
+
+- (void)collapseProxies:(USType *(^)(USType *))resolve {
+    for (USElement *element in self.choices)
+        [element collapseProxies:resolve];
+}
+
++ (NSArray *)codingKeys {
+    return [[super codingKeys] arrayByAddingObjectsFromArray:@[@"choices"]];
+}
 @end
 
 @implementation USComplexType
@@ -210,12 +419,55 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
             break;
         }
     }
+    ret[@"hasPresenceElements"] = @NO;
+    for (USElement *element in ret[@"sequenceElements"]) {
+        if ([element.tracksPresence boolValue]) {
+            ret[@"hasPresenceElements"] = @YES;
+            break;
+        }
+    }
     ret[@"attributes"] = self.attributes ?: @[];
     ret[@"hasAttributes"] = @([self.attributes count] > 0);
+    ret[@"attributeDispatch"] = attributeDispatch(self);
     ret[@"hasMembers"] = @([ret[@"hasSequenceElements"] boolValue]
                         || [ret[@"hasSuperElements"] boolValue]
                         || [ret[@"hasAttributes"] boolValue]
                         || [ret[@"hasSuperAttributes"] boolValue]);
+    ret[@"snapshotFields"] = [self snapshotFields];
+    return ret;
+}
+
+// Tagged by position: sequence elements, then attributes, then the simple content
+- (NSArray *)snapshotFields {
+    NSMutableArray *fields = [NSMutableArray new];
+    NSUInteger tag = 0;
+    for (USElement *element in flattedSubstitutions(self.sequenceElements ?: @[]))
+        [fields addObject:snapshotField(++tag, element.name, element.uname, element.isArray ? nil : element.type,
+                                        element.scalarTypeName, [element.tracksPresence boolValue])];
+    for (USAttribute *attribute in self.attributes)
+        [fields addObject:snapshotField(++tag, attribute.name, nil, attribute.type, nil, NO)];
+    if (!self.superClass.asComplex && [self.superClass isKindOfClass:[USPrimitiveType class]])
+        [fields addObject:snapshotField(++tag, @"_content", nil, nil, nil, NO)];
+    return fields;
+}
+
+- (NSString *)snapshotSignature {
+    NSMutableArray *fields = [NSMutableArray new];
+    for (NSDictionary *field in [self snapshotFields])
+        [fields addObject:[NSString stringWithFormat:@"%@:%@:%@", field[@"tag"], field[@"name"], field[@"decoder"]]];
+    return [NSString stringWithFormat:@"%@ : %@ {%@}", [super snapshotSignature],
+            self.superClass.className ?: @"", [fields componentsJoinedByString:@","]];
+}
+
+- (NSArray *)referencedTypes {
+    NSMutableArray *ret = [NSMutableArray new];
+    if (self.superClass)
+        [ret addObject:self.superClass];
+    [ret addObjectsFromArray:typesOfElements(flattedSubstitutions(self.sequenceElements ?: @[]))];
+    for (USAttribute *attribute in self.attributes) {
+        if (attribute.type)
+            [ret addObject:attribute.type];
+    }
     return ret;
 }
 
@@ -223,9 +475,27 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
     return [USComplexType complexTypeWithName:newTypeName prefix:newTypePrefix
                                      elements:@[] attributes:@[] base:self];
 }
+
+- (void)collapseProxies:(USType *(^)(USType *))resolve {
+    if (self.superClass)
+        self.superClass = resolve(self.superClass);
+    for (USElement *element in self.sequenceElements)
+        [element collapseProxies:resolve];
+    for (USAttribute *attribute in self.attributes)
+        [attribute collapseProxies:resolve];
+}
+
++ (NSArray *)codingKeys {
+    return [[super codingKeys] arrayByAddingObjectsFromArray:@[@"sequenceElements", @"attributes", @"superClass"]];
+}
 @end
 
-@implementation USType
+@implementation USType {
+    NSString *_memoizedSnapshotSignature;
+    NSString *_memoizedSnapshotFingerprint;
+    BOOL _hasMemoizedSnapshotFingerprint;
+}
+
 - (id)initWithName:(NSString *)name prefix:(NSString *)prefix {
     self = [super init];
     self.typeName = name;
@@ -300,6 +570,14 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
     return @NO;
 }
 
+- (NSString *)scalarTypeName {
+    return nil;
+}
+
+- (NSArray *)referencedTypes {
+    return @[];
+}
+
 - (NSMutableDictionary *)templateKeyDictionary {
 	NSMutableDictionary *ret = [NSMutableDictionary dictionary];
 	ret[@"className"] = self.className;
@@ -309,12 +587,62 @@ static NSArray *flattedSubstitutions(NSArray *elements) {
         ret[@"factoryClassName"] = self.factoryClassName;
 	ret[@"variableTypeName"] = self.variableTypeName;
 	ret[@"isEnum"] = self.isEnum;
+    if (self.scalarTypeName)
+        ret[@"scalarTypeName"] = self.scalarTypeName;
+    NSString *snapshotFingerprint = [self memoizedSnapshotFingerprint];
+    if (snapshotFingerprint)
+        ret[@"snapshotFingerprint"] = snapshotFingerprint;
     return ret;
 }
 
+- (NSString *)snapshotSignature {
+    return [NSString stringWithFormat:@"%@ %@ %@", self.className, self.variableTypeName, self.scalarTypeName ?: @""];
+}
+
+- (NSString *)memoizedSnapshotSignature {
+    if (!_memoizedSnapshotSignature)
+        _memoizedSnapshotSignature = [self snapshotSignature];
+    return _memoizedSnapshotSignature;
+}
+
+- (NSString *)memoizedSnapshotFingerprint {
+    if (!_hasMemoizedSnapshotFingerprint) {
+        _memoizedSnapshotFingerprint = [self snapshotFingerprint];
+        _hasMemoizedSnapshotFingerprint = YES;
+    }
+    return _memoizedSnapshotFingerprint;
+}
+
+// FNV-1a of the signatures of this type and everything it refers to, as a C literal
+- (NSString *)snapshotFingerprint {
+    NSMutableString *signatures = [NSMutableString new];
+    appendSnapshotSignatures(self, signatures, [NSMutableSet new]);
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *c = [signatures UTF8String]; *c; ++c)
+        hash = (hash ^ (uint8_t)*c) * 1099511628211ULL;
+    return [NSString stringWithFormat:@"0x%016llxULL", (unsigned long long)hash];
+}
+
 - (instancetype)deriveWithName:(NSString *)newTypeName prefix:(NSString *)newTypePrefix {
     return nil;
 }
+
+- (void)collapseProxies:(USType *(^)(USType *))resolve {
+}
+
++ (NSArray *)codingKeys {
+    return @[@"typeName", @"prefix"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [self initWithName:nil prefix:nil]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
 
 @implementation USProxyType
@@ -22,10 +22,12 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USPortType;
 @class USSchema;
 
-@interface USBinding : NSObject
+@interface USBinding : NSObject <USCoding>
 @property (nonatomic, copy) NSString *prefix;
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic, copy) NSString *soapVersion;
@@ -98,4 +98,18 @@
              @"inputHeaders": [inputHeaders allValues]};
 }
 
+
++ (NSArray *)codingKeys {
+    return @[@"prefix", @"name", @"soapVersion", @"operations"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
@@ -0,0 +1,47 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+// Records what a generation run read and wrote, so that the next run into the
+// same output directory can be skipped entirely when none of its inputs
+// changed, and so that outputs which are no longer generated can be removed.
+@interface USManifest : NSObject
+- (id)initWithOutputDirectory:(NSURL *)outDir;
+
+// YES if every input recorded by the previous run still hashes to the same
+// fingerprint and every recorded output still exists.
+- (BOOL)isUpToDate;
+
+// The inputs recorded by the previous run
+- (NSArray *)inputURLs;
+
+// Fingerprint the given input URLs (WSDL, imported documents and templates)
+// together with the generation options, delete any output from the previous
+// run which isn't in outputs, and save the manifest.
+- (void)recordInputs:(NSArray *)inputURLs outputs:(NSSet *)outputs;
+
+// User defaults which change the generated code
++ (NSArray *)optionKeys;
+// The subset of optionKeys which the parser reads, and so change the parsed model
++ (NSArray *)parseOptionKeys;
+@end
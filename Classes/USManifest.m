@@ -0,0 +1,133 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "USManifest.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+static NSString *const USManifestFileName = @".wsdl2objc-manifest.plist";
+
+@interface USManifest ()
+@property (nonatomic, strong) NSURL *outDir;
+@property (nonatomic, strong) NSDictionary *previous;
+@end
+
+@implementation USManifest
++ (NSArray *)optionKeys {
+    return @[@"wsdlPath", @"addTagToServiceName", @"templateDirectory",
+             @"splitTypes", @"shardCount",
+             @"pruneUnreachableTypes", @"keepTypes", @"scalarNumbers", @"loadDriver"];
+}
+
+// Keep in sync with the defaults read under USParser and USService
++ (NSArray *)parseOptionKeys {
+    return @[@"addTagToServiceName"];
+}
+
+- (id)initWithOutputDirectory:(NSURL *)outDir {
+    if ((self = [super init])) {
+        self.outDir = outDir;
+        self.previous = [NSDictionary dictionaryWithContentsOfURL:[self manifestURL]];
+    }
+    return self;
+}
+
+- (NSURL *)manifestURL {
+    return [NSURL URLWithString:USManifestFileName relativeToURL:self.outDir];
+}
+
+- (NSString *)fingerprintForInputs:(NSArray *)inputURLs {
+    CC_SHA1_CTX ctx;
+    CC_SHA1_Init(&ctx);
+
+    NSArray *sorted = [inputURLs sortedArrayUsingSelector:@selector(compare:)];
+    for (NSString *url in sorted) {
+        NSData *data = [NSData dataWithContentsOfURL:[NSURL URLWithString:url]];
+        if (!data) return nil;
+
+        NSData *name = [url dataUsingEncoding:NSUTF8StringEncoding];
+        CC_SHA1_Update(&ctx, [name bytes], (CC_LONG)[name length]);
+        CC_SHA1_Update(&ctx, "\0", 1);
+        CC_SHA1_Update(&ctx, [data bytes], (CC_LONG)[data length]);
+    }
+
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    NSMutableString *options = [NSMutableString stringWithFormat:@"version=%@\n",
+                                [[NSBundle mainBundle] infoDictionary][(NSString *)kCFBundleVersionKey]];
+    for (NSString *key in [USManifest optionKeys])
+        [options appendFormat:@"%@=%@\n", key, [defaults objectForKey:key] ?: @""];
+    NSData *optionData = [options dataUsingEncoding:NSUTF8StringEncoding];
+    CC_SHA1_Update(&ctx, [optionData bytes], (CC_LONG)[optionData length]);
+
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1_Final(digest, &ctx);
+
+    NSMutableString *ret = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_SHA1_DIGEST_LENGTH; ++i)
+        [ret appendFormat:@"%02x", digest[i]];
+    return ret;
+}
+
+- (BOOL)isUpToDate {
+    NSString *fingerprint = self.previous[@"fingerprint"];
+    NSArray *inputs = self.previous[@"inputs"];
+    if (!fingerprint || ![inputs count]) return NO;
+
+    for (NSString *output in self.previous[@"outputs"]) {
+        NSURL *url = [NSURL URLWithString:output relativeToURL:self.outDir];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:[url path]])
+            return NO;
+    }
+
+    return [fingerprint isEqualToString:[self fingerprintForInputs:inputs]];
+}
+
+- (NSArray *)inputURLs {
+    NSMutableArray *ret = [NSMutableArray new];
+    for (NSString *input in self.previous[@"inputs"])
+        [ret addObject:[NSURL URLWithString:input]];
+    return ret;
+}
+
+- (void)recordInputs:(NSArray *)inputURLs outputs:(NSSet *)outputs {
+    NSArray *inputs = [[NSSet setWithArray:[inputURLs valueForKey:@"absoluteString"]] allObjects];
+    NSString *fingerprint = [self fingerprintForInputs:inputs];
+
+    for (NSString *output in self.previous[@"outputs"]) {
+        if ([outputs containsObject:output]) continue;
+
+        NSLog(@"Removing stale output %@", output);
+        [[NSFileManager defaultManager] removeItemAtURL:[NSURL URLWithString:output relativeToURL:self.outDir]
+                                                  error:nil];
+    }
+
+    NSMutableDictionary *manifest = [NSMutableDictionary new];
+    manifest[@"inputs"] = inputs;
+    manifest[@"outputs"] = [[outputs allObjects] sortedArrayUsingSelector:@selector(compare:)];
+    if (fingerprint)
+        manifest[@"fingerprint"] = fingerprint;
+
+    [manifest writeToURL:[self manifestURL] atomically:YES];
+    self.previous = manifest;
+}
+
+@end
@@ -22,9 +22,11 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USSchema;
 
-@interface USMessage : NSObject
+@interface USMessage : NSObject <USCoding>
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic, strong) NSDictionary *parts;
 
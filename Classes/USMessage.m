@@ -51,4 +51,18 @@
     return message;
 
 }
+
++ (NSArray *)codingKeys {
+    return @[@"name", @"parts"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
@@ -0,0 +1,40 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class USWSDL;
+
+// Keeps parsed models on disk, keyed by the URL of the WSDL they were parsed
+// from, so that runs where only the templates or options changed can skip
+// parsing. A cached model is only used if every document it was parsed from
+// still has the same contents.
+@interface USModelCache : NSObject
+- (id)initWithDirectory:(NSURL *)directory;
+
+// The model previously stored for wsdlURL, or nil if there isn't one or any
+// of its documents changed. documentURLs is set to the URLs of the documents
+// the model was parsed from.
+- (USWSDL *)modelForURL:(NSURL *)wsdlURL documentURLs:(NSArray **)documentURLs;
+
+- (void)storeModel:(USWSDL *)wsdl forURL:(NSURL *)wsdlURL documentURLs:(NSArray *)documentURLs;
+@end
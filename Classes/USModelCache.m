@@ -0,0 +1,131 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "USModelCache.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+#import "USManifest.h"
+#import "USWSDL.h"
+
+// Bump when the model classes or their coding keys change
+static const NSInteger USModelCacheFormat = 2;
+
+static NSString *hexDigest(NSData *data) {
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1([data bytes], (CC_LONG)[data length], digest);
+
+    NSMutableString *ret = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_SHA1_DIGEST_LENGTH; ++i)
+        [ret appendFormat:@"%02x", digest[i]];
+    return ret;
+}
+
+@interface USModelCache ()
+@property (nonatomic, copy) NSURL *directory;
+@end
+
+@implementation USModelCache
+- (id)initWithDirectory:(NSURL *)directory {
+    if ((self = [super init])) {
+        self.directory = directory;
+        [[NSFileManager defaultManager] createDirectoryAtURL:directory withIntermediateDirectories:YES
+                                                  attributes:nil error:nil];
+    }
+    return self;
+}
+
+// Keyed by the options the parser reads as well as the URL, so that models
+// parsed with different options don't overwrite each other
+- (NSURL *)cacheURLForWSDLURL:(NSURL *)wsdlURL {
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    NSMutableString *keyString = [[[wsdlURL absoluteURL] absoluteString] mutableCopy];
+    for (NSString *option in [USManifest parseOptionKeys])
+        [keyString appendFormat:@"\n%@=%@", option, [defaults objectForKey:option] ?: @""];
+    NSString *key = hexDigest([keyString dataUsingEncoding:NSUTF8StringEncoding]);
+    return [self.directory URLByAppendingPathComponent:[key stringByAppendingPathExtension:@"model"]];
+}
+
+- (NSString *)version {
+    return [NSString stringWithFormat:@"%@/%ld",
+            [[NSBundle mainBundle] infoDictionary][(NSString *)kCFBundleVersionKey], (long)USModelCacheFormat];
+}
+
+- (USWSDL *)modelForURL:(NSURL *)wsdlURL documentURLs:(NSArray **)documentURLs {
+    NSData *data = [NSData dataWithContentsOfURL:[self cacheURLForWSDLURL:wsdlURL]];
+    if (!data) return nil;
+
+    @try {
+        NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+        if (![[unarchiver decodeObjectForKey:@"version"] isEqualToString:[self version]])
+            return nil;
+
+        // Check the documents before decoding the model, as that's the slow part
+        NSArray *documents = [unarchiver decodeObjectForKey:@"documents"];
+        NSDictionary *digests = [unarchiver decodeObjectForKey:@"digests"];
+        NSMutableArray *urls = [NSMutableArray arrayWithCapacity:[documents count]];
+        for (NSString *document in documents) {
+            NSURL *url = [NSURL URLWithString:document];
+            NSData *contents = [NSData dataWithContentsOfURL:url];
+            if (!contents || ![digests[document] isEqualToString:hexDigest(contents)])
+                return nil;
+            [urls addObject:url];
+        }
+
+        USWSDL *wsdl = [unarchiver decodeObjectForKey:@"wsdl"];
+        [unarchiver finishDecoding];
+        if (wsdl && documentURLs)
+            *documentURLs = urls;
+        return wsdl;
+    }
+    @catch (NSException *e) {
+        NSLog(@"Ignoring unreadable model cache for %@: %@", wsdlURL, e);
+        return nil;
+    }
+}
+
+- (void)storeModel:(USWSDL *)wsdl forURL:(NSURL *)wsdlURL documentURLs:(NSArray *)documentURLs {
+    if (!wsdl) return;
+
+    NSMutableArray *documents = [NSMutableArray arrayWithCapacity:[documentURLs count]];
+    NSMutableDictionary *digests = [NSMutableDictionary new];
+    for (NSURL *url in documentURLs) {
+        NSString *document = [[url absoluteURL] absoluteString];
+        NSData *contents = [NSData dataWithContentsOfURL:url];
+        if (!contents) return;
+        [documents addObject:document];
+        digests[document] = hexDigest(contents);
+    }
+
+    NSMutableData *data = [NSMutableData new];
+    NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+    [archiver encodeObject:[self version] forKey:@"version"];
+    [archiver encodeObject:documents forKey:@"documents"];
+    [archiver encodeObject:digests forKey:@"digests"];
+    [archiver encodeObject:wsdl forKey:@"wsdl"];
+    [archiver finishEncoding];
+
+    NSError *error;
+    if (![data writeToURL:[self cacheURLForWSDLURL:wsdlURL] options:NSDataWritingAtomic error:&error])
+        NSLog(@"Unable to write model cache for %@: %@", wsdlURL, error);
+}
+@end
@@ -22,11 +22,13 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USOperationInterface;
 @class USPortType;
 @class USSchema;
 
-@interface USOperation : NSObject
+@interface USOperation : NSObject <USCoding>
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic, copy) NSString *soapAction;
 @property (nonatomic, strong) USOperationInterface *input;
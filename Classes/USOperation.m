@@ -97,4 +97,18 @@
     return [self invokeStringWithAsync:YES];
 }
 
+
++ (NSArray *)codingKeys {
+    return @[@"name", @"soapAction", @"input", @"output"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
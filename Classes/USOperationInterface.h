@@ -22,10 +22,12 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USMessage;
 @class USSchema;
 
-@interface USOperationInterface : NSObject
+@interface USOperationInterface : NSObject <USCoding>
 @property (nonatomic, strong) NSOrderedSet *headers;
 @property (nonatomic, strong) NSArray *bodyParts;
 @property (nonatomic, readonly) NSString *className;
@@ -76,4 +76,18 @@
 	return @([self.headers count] > 0);
 }
 
+
++ (NSArray *)codingKeys {
+    return @[@"headers", @"bodyParts"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
@@ -31,11 +31,17 @@ NSLog(@"%s[%d] >> " __NSSTRING, __PRETTY_FUNCTION__, __LINE__, ##__VA_ARGS__ )
 
 @class USWSDL;
 @class USSchema;
+@class USResourceCache;
 
 @interface USParser : NSObject
 - (id)initWithURL:(NSURL *)anURL;
 - (USWSDL*)parse;
 
+// URLs of the WSDL and every document it imported, in load order
+@property (nonatomic, readonly) NSArray *documentURLs;
+// If set, documents are fetched through this cache rather than directly
+@property (nonatomic, strong) USResourceCache *resourceCache;
+
 - (void)processImportElement:(NSXMLElement *)el wsdl:(USWSDL *)wsdl;
 - (void)processSchemaElement:(NSXMLElement *)el wsdl:(USWSDL *)wsdl;
 - (void)processNamespace:(NSXMLNode *)ns wsdl:(USWSDL *)wsdl;
@@ -29,6 +29,8 @@
 #import "USElement.h"
 #import "USMessage.h"
 #import "USPortType.h"
+#import "USProfiler.h"
+#import "USResourceCache.h"
 #import "USSchema.h"
 #import "USService.h"
 #import "USType.h"
@@ -36,24 +38,45 @@
 
 @interface USParser ()
 @property (nonatomic, strong) NSURL *baseURL;
+@property (nonatomic, strong) NSMutableArray *loadedURLs;
 @end
 
 @implementation USParser
 - (id)initWithURL:(NSURL *)url {
-    if ((self = [super init]))
+    if ((self = [super init])) {
         self.baseURL = url;
+        self.loadedURLs = [NSMutableArray new];
+    }
     return self;
 }
 
+- (NSArray *)documentURLs {
+    return [self.loadedURLs copy];
+}
+
+- (NSXMLDocument *)loadDocumentAtURL:(NSURL *)url error:(NSError **)error {
+    uint64_t start = USProfilerBegin(USProfilerPhaseDocumentLoad);
+    NSXMLDocument *document;
+    if (self.resourceCache) {
+        NSData *data = [self.resourceCache dataWithContentsOfURL:url error:error];
+        if (data)
+            document = [[NSXMLDocument alloc] initWithData:data options:NSXMLNodeOptionsNone error:error];
+    }
+    else
+        document = [[NSXMLDocument alloc] initWithContentsOfURL:url options:NSXMLNodeOptionsNone error:error];
+    USProfilerEnd(USProfilerPhaseDocumentLoad, start);
+    return document;
+}
+
 - (USWSDL *)parse {
     NSError *error = nil;
-    NSXMLDocument *document = [[NSXMLDocument alloc] initWithContentsOfURL:self.baseURL
-                                                                   options:NSXMLNodeOptionsNone error:&error];
+    NSXMLDocument *document = [self loadDocumentAtURL:self.baseURL error:&error];
 
     if (error) {
         NSLog(@"Unable to parse XML document from %@: %@", self.baseURL, error);
         return nil;
     }
+    [self.loadedURLs addObject:self.baseURL];
 
     NSXMLElement *definitions = [document rootElement];
 
@@ -63,7 +86,10 @@
     }
 
     USWSDL *wsdl = [USWSDL new];
+    uint64_t parseStart = USProfilerBegin(USProfilerPhaseParse);
     [self processDefinitionsElement:definitions wsdl:wsdl];
+    [wsdl collapseProxies];
+    USProfilerEnd(USProfilerPhaseParse, parseStart);
     return wsdl;
 }
 
@@ -175,11 +201,12 @@
         NSLog(@"Processing schema import at location: %@", location);
 
         NSError *error = nil;
-        NSXMLDocument *document = [[NSXMLDocument alloc] initWithContentsOfURL:location options:0 error:&error];
+        NSXMLDocument *document = [self loadDocumentAtURL:location error:&error];
         if (error) {
             NSLog(@"Unable to parse XML document from %@ (ignored): %@", location, error);
             return;
         }
+        [self.loadedURLs addObject:location];
 
         NSXMLElement *schemaElement = [document rootElement];
         if ([[schemaElement localName] isNotEqualTo:@"schema"]) {
@@ -202,11 +229,12 @@
     NSLog(@"Processing definitions import at location: %@", location);
 
     NSError *error = nil;
-    NSXMLDocument *document = [[NSXMLDocument alloc] initWithContentsOfURL:location options:0 error:&error];
+    NSXMLDocument *document = [self loadDocumentAtURL:location error:&error];
     if (error) {
         NSLog(@"Unable to parse XML document from %@ (ignored): %@", location, error);
         return;
     }
+    [self.loadedURLs addObject:location];
 
     NSXMLElement *definitionsElement = [document rootElement];
     if ([[definitionsElement localName] isNotEqualTo:@"definitions"]) {
@@ -22,10 +22,12 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USBinding;
 @class USSchema;
 
-@interface USPort : NSObject
+@interface USPort : NSObject <USCoding>
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic, strong) USBinding *binding;
 @property (nonatomic, copy) NSString *address;
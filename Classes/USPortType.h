@@ -22,10 +22,12 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USMessage;
 @class USSchema;
 
-@interface USPortTypeOperation : NSObject
+@interface USPortTypeOperation : NSObject <USCoding>
 @property (nonatomic, strong) NSString *name;
 @property (nonatomic, strong) USMessage *input;
 @property (nonatomic, strong) USMessage *output;
@@ -33,7 +35,7 @@
 + (USPortTypeOperation *)operationWithElement:(NSXMLElement *)el schema:(USSchema *)schema;
 @end
 
-@interface USPortType : NSObject
+@interface USPortType : NSObject <USCoding>
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic, strong) NSDictionary *operations;
 
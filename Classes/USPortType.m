@@ -45,6 +45,20 @@
     }
     return operation;
 }
+
++ (NSArray *)codingKeys {
+    return @[@"name", @"input", @"output"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
 
 @implementation USPortType
@@ -60,4 +74,18 @@
     portType.operations = operations;
     return portType;
 }
+
++ (NSArray *)codingKeys {
+    return @[@"name", @"operations"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
@@ -0,0 +1,53 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+// Accumulates wall time and malloc calls in each phase of generation. Disabled
+// unless a benchmark report was requested, in which case begin/end cost a clock
+// read and every allocation an atomic increment.
+// Nested intervals of the same phase are only counted once, so e.g. wait
+// resolution triggered from inside another wait's callback isn't counted
+// twice. Not thread safe.
+typedef NS_ENUM(NSUInteger, USProfilerPhase) {
+    USProfilerPhaseDocumentLoad,
+    USProfilerPhaseParse,            // includes loading imported documents and wait resolution
+    USProfilerPhaseWaitResolution,
+    USProfilerPhaseTemplateExpansion,
+    USProfilerPhaseFileOutput,
+    USProfilerPhaseCount
+};
+
+extern BOOL USProfilerEnabled;
+
+uint64_t USProfilerBegin(USProfilerPhase phase);
+void USProfilerEnd(USProfilerPhase phase, uint64_t start);
+
+@interface USProfiler : NSObject
+// Enables the profiler and starts the wall clock
++ (void)start;
+// Phase timings and allocation counts plus wall time and allocations since the
+// profiler was enabled, peak RSS and malloc statistics
++ (NSDictionary *)report;
+// Writes the report as JSON
++ (BOOL)writeReportToPath:(NSString *)path;
+@end
@@ -0,0 +1,186 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "USProfiler.h"
+
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+#import <malloc/malloc.h>
+#import <sys/resource.h>
+
+BOOL USProfilerEnabled = NO;
+
+static uint64_t phaseTicks[USProfilerPhaseCount];
+static NSUInteger phaseCounts[USProfilerPhaseCount];
+static NSUInteger phaseDepth[USProfilerPhaseCount];
+static uint64_t phaseAllocations[USProfilerPhaseCount];
+static uint64_t phaseAllocationsAtBegin[USProfilerPhaseCount];
+static uint64_t enabledAt;
+
+static NSString *const phaseNames[USProfilerPhaseCount] = {
+    @"documentLoad",
+    @"parse",
+    @"waitResolution",
+    @"templateExpansion",
+    @"fileOutput",
+};
+
+static double secondsFromTicks(uint64_t ticks) {
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return (double)ticks * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+#pragma mark Allocation counting
+
+// Counts every allocation from the default malloc zone, on any thread, while
+// the profiler is enabled
+static volatile uint64_t allocationCount;
+
+static void *(*realMalloc)(struct _malloc_zone_t *, size_t);
+static void *(*realCalloc)(struct _malloc_zone_t *, size_t, size_t);
+static void *(*realRealloc)(struct _malloc_zone_t *, void *, size_t);
+
+static void *countingMalloc(struct _malloc_zone_t *zone, size_t size) {
+    __sync_fetch_and_add(&allocationCount, 1);
+    return realMalloc(zone, size);
+}
+
+static void *countingCalloc(struct _malloc_zone_t *zone, size_t count, size_t size) {
+    __sync_fetch_and_add(&allocationCount, 1);
+    return realCalloc(zone, count, size);
+}
+
+static void *countingRealloc(struct _malloc_zone_t *zone, void *ptr, size_t size) {
+    __sync_fetch_and_add(&allocationCount, 1);
+    return realRealloc(zone, ptr, size);
+}
+
+static void installAllocationCounter(void) {
+    malloc_zone_t *zone = malloc_default_zone();
+    vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(*zone), 0, VM_PROT_READ | VM_PROT_WRITE);
+    realMalloc = zone->malloc;
+    realCalloc = zone->calloc;
+    realRealloc = zone->realloc;
+    zone->malloc = countingMalloc;
+    zone->calloc = countingCalloc;
+    zone->realloc = countingRealloc;
+    vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(*zone), 0, VM_PROT_READ);
+}
+
+#pragma mark Phases
+
+uint64_t USProfilerBegin(USProfilerPhase phase) {
+    if (!USProfilerEnabled) return 0;
+    if (phaseDepth[phase]++) return 0;
+    phaseAllocationsAtBegin[phase] = allocationCount;
+    return mach_absolute_time();
+}
+
+void USProfilerEnd(USProfilerPhase phase, uint64_t start) {
+    if (!USProfilerEnabled) return;
+    if (--phaseDepth[phase]) return;
+    phaseTicks[phase] += mach_absolute_time() - start;
+    phaseAllocations[phase] += allocationCount - phaseAllocationsAtBegin[phase];
+    ++phaseCounts[phase];
+}
+
+#pragma mark Report
+
+// NSJSONSerialization needs 10.7, and the report only holds dictionaries,
+// strings and numbers
+static void appendJSON(NSMutableString *json, id value, NSUInteger indent) {
+    if ([value isKindOfClass:[NSDictionary class]]) {
+        NSString *padding = [@"" stringByPaddingToLength:indent + 2 withString:@" " startingAtIndex:0];
+        [json appendString:@"{"];
+        NSArray *keys = [[value allKeys] sortedArrayUsingSelector:@selector(compare:)];
+        for (NSUInteger i = 0; i < [keys count]; ++i) {
+            [json appendFormat:@"%@\n%@", i ? @"," : @"", padding];
+            appendJSON(json, keys[i], indent + 2);
+            [json appendString:@": "];
+            appendJSON(json, value[keys[i]], indent + 2);
+        }
+        [json appendFormat:@"\n%@}", [padding substringFromIndex:2]];
+    }
+    else if ([value isKindOfClass:[NSString class]]) {
+        [json appendString:@"\""];
+        for (NSUInteger i = 0; i < [value length]; ++i) {
+            unichar c = [value characterAtIndex:i];
+            if (c == '"' || c == '\\')
+                [json appendFormat:@"\\%C", c];
+            else if (c < 0x20)
+                [json appendFormat:@"\\u%04x", c];
+            else
+                [json appendFormat:@"%C", c];
+        }
+        [json appendString:@"\""];
+    }
+    else
+        [json appendString:[value stringValue]];
+}
+
+@implementation USProfiler
++ (void)start {
+    installAllocationCounter();
+    enabledAt = mach_absolute_time();
+    USProfilerEnabled = YES;
+}
+
++ (NSDictionary *)report {
+    NSMutableDictionary *phases = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i < USProfilerPhaseCount; ++i) {
+        phases[phaseNames[i]] = @{@"seconds": @(secondsFromTicks(phaseTicks[i])),
+                                  @"count": @(phaseCounts[i]),
+                                  @"allocations": @(phaseAllocations[i])};
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+
+    return @{@"wallSeconds": @(enabledAt ? secondsFromTicks(mach_absolute_time() - enabledAt) : 0),
+             @"phases": phases,
+             @"allocations": @(allocationCount),
+             @"memory": @{@"peakRSSBytes": @(usage.ru_maxrss), // bytes on OS X
+                          @"mallocBlocksInUse": @(stats.blocks_in_use),
+                          @"mallocBytesInUse": @(stats.size_in_use),
+                          @"mallocMaxBytesInUse": @(stats.max_size_in_use),
+                          // Bytes the zones have reserved from the system at this moment, not a running total
+                          @"mallocBytesReserved": @(stats.size_allocated)}};
+}
+
++ (BOOL)writeReportToPath:(NSString *)path {
+    NSMutableString *json = [NSMutableString new];
+    appendJSON(json, [self report], 0);
+    [json appendString:@"\n"];
+
+    NSError *error;
+    if (![json writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:&error]) {
+        NSLog(@"Unable to write benchmark report to %@: %@", path, error);
+        return NO;
+    }
+    return YES;
+}
+@end
@@ -0,0 +1,38 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+// Contents of documents and templates shared between the parsers and writers
+// of a batch run, so that imports common to several WSDLs are only fetched
+// once and templates are only read once. Safe to use from several threads.
+@interface USResourceCache : NSObject
+// The contents of url, fetching it if this is the first request for it.
+// Failed fetches aren't cached.
+- (NSData *)dataWithContentsOfURL:(NSURL *)url error:(NSError **)error;
+
+// The UTF-8 contents of the file at path, or nil if it couldn't be read
+- (NSString *)stringWithContentsOfFile:(NSString *)path;
+
+// Forget the contents of these URLs, so that they're read again when next used
+- (void)invalidateURLs:(id<NSFastEnumeration>)urls;
+@end
@@ -0,0 +1,85 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "USResourceCache.h"
+
+@interface USResourceCache ()
+@property (nonatomic, strong) NSMutableDictionary *documents;
+@property (nonatomic, strong) NSMutableDictionary *strings;
+@end
+
+@implementation USResourceCache
+- (id)init {
+    if ((self = [super init])) {
+        self.documents = [NSMutableDictionary new];
+        self.strings = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+// Fetches happen outside the lock, so two jobs asking for the same document
+// at once may both fetch it, but neither waits on unrelated fetches
+- (NSData *)dataWithContentsOfURL:(NSURL *)url error:(NSError **)error {
+    NSURL *key = [url absoluteURL];
+    @synchronized (self) {
+        NSData *data = self.documents[key];
+        if (data) return data;
+    }
+
+    NSData *data = [NSData dataWithContentsOfURL:key options:0 error:error];
+    if (!data) return nil;
+
+    @synchronized (self) {
+        if (!self.documents[key])
+            self.documents[key] = data;
+        return self.documents[key];
+    }
+}
+
+- (NSString *)stringWithContentsOfFile:(NSString *)path {
+    if (!path) return nil;
+    @synchronized (self) {
+        NSString *string = self.strings[path];
+        if (string) return string;
+    }
+
+    NSString *string = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+    if (!string) return nil;
+
+    @synchronized (self) {
+        if (!self.strings[path])
+            self.strings[path] = string;
+        return self.strings[path];
+    }
+}
+
+- (void)invalidateURLs:(id<NSFastEnumeration>)urls {
+    @synchronized (self) {
+        for (NSURL *url in urls) {
+            NSURL *absoluteURL = [url absoluteURL];
+            [self.documents removeObjectForKey:absoluteURL];
+            if ([absoluteURL isFileURL])
+                [self.strings removeObjectForKey:[absoluteURL path]];
+        }
+    }
+}
+@end
@@ -22,9 +22,11 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USSchema;
 
-@interface USService : NSObject
+@interface USService : NSObject <USCoding>
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic, readonly) NSString *className;
 @property (nonatomic, strong) NSArray *ports;
@@ -62,4 +62,18 @@
              @"className": self.className,
              @"ports": self.ports};
 }
+
++ (NSArray *)codingKeys {
+    return @[@"name", @"ports"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
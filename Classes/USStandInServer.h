@@ -0,0 +1,48 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class USWSDL;
+
+// A local HTTP server which answers every operation of a parsed WSDL with a
+// synthetic response built from the output message's schema, for load testing
+// generated clients without a real endpoint. Responses are built once, when
+// the server starts listening.
+@interface USStandInServer : NSObject
+// Items written for each repeated element or array type
+@property (nonatomic) NSUInteger itemCount;
+// Nesting depth beyond which complex types are written empty
+@property (nonatomic) NSUInteger maxDepth;
+// Length of each synthetic string value
+@property (nonatomic) NSUInteger stringLength;
+// Delay before each response is written
+@property (nonatomic) NSTimeInterval latency;
+// Fraction of requests, between 0 and 1, answered with a SOAP fault instead
+@property (nonatomic) double faultRate;
+// Write bodies with chunked transfer encoding in chunks of this size; 0 sends a Content-Length
+@property (nonatomic) NSUInteger chunkSize;
+
+- (id)initWithWSDL:(USWSDL *)wsdl;
+// Listens on the loopback interface; each connection is served on a thread of its own
+- (BOOL)listenOnPort:(uint16_t)port error:(NSError **)error;
+@end
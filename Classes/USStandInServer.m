@@ -0,0 +1,451 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "USStandInServer.h"
+
+#import <arpa/inet.h>
+#import <netinet/in.h>
+#import <netinet/tcp.h>
+#import <signal.h>
+#import <sys/socket.h>
+
+#import "USAttribute.h"
+#import "USBinding.h"
+#import "USElement.h"
+#import "USOperation.h"
+#import "USOperationInterface.h"
+#import "USSchema.h"
+#import "USType.h"
+#import "USWSDL.h"
+
+static NSString *const soap11Namespace = @"http://schemas.xmlsoap.org/soap/envelope/";
+static NSString *const soap12Namespace = @"http://www.w3.org/2003/05/soap-envelope";
+
+// What to answer for one operation
+@interface USStandInRoute : NSObject
+@property (nonatomic, strong) NSData *response;
+@property (nonatomic, strong) NSData *fault;
+@property (nonatomic, copy) NSString *contentType;
+@end
+
+@implementation USStandInRoute
+@end
+
+@interface USStandInServer ()
+@property (nonatomic, strong) USWSDL *wsdl;
+@property (nonatomic, strong) NSString *sampleString;
+@property (nonatomic) NSUInteger sampleCounter;
+// By SOAP action, and by the name of the request's body element
+@property (nonatomic, strong) NSMutableDictionary *routesByAction;
+@property (nonatomic, strong) NSMutableDictionary *routesByElement;
+@end
+
+static BOOL writeAll(int fd, const void *bytes, size_t length) {
+    while (length) {
+        ssize_t written = write(fd, bytes, length);
+        if (written <= 0) return NO;
+        bytes = (const char *)bytes + written;
+        length -= (size_t)written;
+    }
+    return YES;
+}
+
+static BOOL readMore(int fd, NSMutableData *buffer) {
+    uint8_t chunk[16384];
+    ssize_t count = read(fd, chunk, sizeof(chunk));
+    if (count <= 0) return NO;
+    [buffer appendBytes:chunk length:(NSUInteger)count];
+    return YES;
+}
+
+@implementation USStandInServer {
+    dispatch_source_t _acceptSource;
+}
+
+- (id)initWithWSDL:(USWSDL *)wsdl {
+    if ((self = [super init])) {
+        self.wsdl = wsdl;
+        self.itemCount = 10;
+        self.maxDepth = 8;
+        self.stringLength = 16;
+    }
+    return self;
+}
+
+#pragma mark Synthetic responses
+
+- (NSString *)sampleStringForType:(USType *)type {
+    NSDictionary *keys = [type templateKeyDictionary];
+    if ([type.isEnum boolValue]) {
+        NSArray *values = keys[@"enumerationValues"];
+        return [values count] ? values[self.sampleCounter++ % [values count]] : @"";
+    }
+
+    // Several XSD primitives share a representation, so samples are picked by
+    // the primitive itself to stay within its lexical space and range
+    NSString *typeName = [keys[@"baseType"] typeName] ?: type.typeName;
+    if ([typeName isEqualToString:@"boolean"])
+        return (self.sampleCounter++ % 2) ? @"true" : @"false";
+    if ([typeName isEqualToString:@"byte"] || [typeName isEqualToString:@"unsignedByte"])
+        return [NSString stringWithFormat:@"%lu", (unsigned long)(self.sampleCounter++ % 100)];
+    if ([typeName isEqualToString:@"positiveInteger"])
+        return [NSString stringWithFormat:@"%lu", (unsigned long)(self.sampleCounter++ % 1000 + 1)];
+    if ([type.variableTypeName isEqualToString:@"NSNumber *"])
+        return [NSString stringWithFormat:@"%lu", (unsigned long)(self.sampleCounter++ % 1000)];
+
+    static NSDictionary *samples;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        samples = @{@"decimal": @"1234.56",
+                    @"dateTime": @"2014-01-01T12:00:00Z",
+                    @"date": @"2014-01-01",
+                    @"time": @"12:00:00",
+                    @"duration": @"P1DT2H",
+                    @"base64Binary": @"c2FtcGxlIGRhdGE="};
+    });
+    return samples[typeName] ?: self.sampleString;
+}
+
+- (void)fillElement:(NSXMLElement *)el withType:(USType *)type depth:(NSUInteger)depth {
+    if (!type) return;
+
+    USComplexType *complex = [type asComplex];
+    if (complex) {
+        if (depth >= self.maxDepth) return;
+
+        NSMutableArray *hierarchy = [NSMutableArray new];
+        for (USComplexType *t = complex; t; t = [t.superClass asComplex])
+            [hierarchy insertObject:t atIndex:0];
+
+        USType *contentType = [[hierarchy firstObject] superClass];
+        if (contentType && ![contentType asComplex])
+            [el setStringValue:[self sampleStringForType:contentType]];
+
+        for (USComplexType *t in hierarchy) {
+            for (USAttribute *attribute in t.attributes)
+                [el addAttribute:[NSXMLNode attributeWithName:attribute.wsdlName
+                                                  stringValue:[self sampleStringForType:attribute.type]]];
+            for (USElement *element in t.sequenceElements) {
+                NSUInteger count = element.isArray ? self.itemCount : 1;
+                for (NSUInteger i = 0; i < count; ++i)
+                    [el addChild:[self elementNamed:element.wsdlName type:element.type depth:depth + 1]];
+            }
+        }
+        return;
+    }
+
+    NSArray *choices = [type templateKeyDictionary][@"choices"];
+    if (choices) {
+        if (depth >= self.maxDepth || ![choices count]) return;
+        NSUInteger count = [type.variableTypeName isEqualToString:@"NSArray *"] ? self.itemCount : 1;
+        for (NSUInteger i = 0; i < count; ++i) {
+            USElement *choice = choices[i % [choices count]];
+            [el addChild:[self elementNamed:choice.wsdlName type:choice.type depth:depth + 1]];
+        }
+        return;
+    }
+
+    [el setStringValue:[self sampleStringForType:type]];
+}
+
+- (NSXMLElement *)elementNamed:(NSString *)name type:(USType *)type depth:(NSUInteger)depth {
+    NSXMLElement *el = [NSXMLElement elementWithName:name];
+    [self fillElement:el withType:type depth:depth];
+    return el;
+}
+
+- (NSData *)envelopeWithBodyChildren:(NSArray *)children soapNamespace:(NSString *)soapNamespace {
+    NSXMLElement *envelope = [NSXMLElement elementWithName:@"soap:Envelope" URI:soapNamespace];
+    [envelope addNamespace:[NSXMLNode namespaceWithName:@"soap" stringValue:soapNamespace]];
+    for (USSchema *schema in [self.wsdl.schemas allValues]) {
+        if ([schema.prefix length] && [schema.fullName length])
+            [envelope addNamespace:[NSXMLNode namespaceWithName:schema.prefix stringValue:schema.fullName]];
+    }
+
+    NSXMLElement *body = [NSXMLElement elementWithName:@"soap:Body" URI:soapNamespace];
+    for (NSXMLElement *child in children)
+        [body addChild:child];
+    [envelope addChild:body];
+
+    NSXMLDocument *document = [NSXMLDocument documentWithRootElement:envelope];
+    [document setCharacterEncoding:@"UTF-8"];
+    return [document XMLData];
+}
+
+- (NSData *)faultWithSoapNamespace:(NSString *)soapNamespace {
+    NSXMLElement *fault = [NSXMLElement elementWithName:@"soap:Fault" URI:soapNamespace];
+    if ([soapNamespace isEqualToString:soap12Namespace]) {
+        NSXMLElement *code = [NSXMLElement elementWithName:@"soap:Code" URI:soapNamespace];
+        [code addChild:[NSXMLElement elementWithName:@"soap:Value" stringValue:@"soap:Receiver"]];
+        NSXMLElement *reason = [NSXMLElement elementWithName:@"soap:Reason" URI:soapNamespace];
+        NSXMLElement *text = [NSXMLElement elementWithName:@"soap:Text" stringValue:@"Injected fault"];
+        [text addAttribute:[NSXMLNode attributeWithName:@"xml:lang" stringValue:@"en"]];
+        [reason addChild:text];
+        [fault addChild:code];
+        [fault addChild:reason];
+    }
+    else {
+        [fault addChild:[NSXMLElement elementWithName:@"faultcode" stringValue:@"soap:Server"]];
+        [fault addChild:[NSXMLElement elementWithName:@"faultstring" stringValue:@"Injected fault"]];
+    }
+    return [self envelopeWithBodyChildren:@[fault] soapNamespace:soapNamespace];
+}
+
+- (void)buildRoutes {
+    self.routesByAction = [NSMutableDictionary new];
+    self.routesByElement = [NSMutableDictionary new];
+    self.sampleString = [@"" stringByPaddingToLength:self.stringLength withString:@"abcdefghijklmnopqrstuvwxyz" startingIndex:0];
+
+    for (USSchema *schema in [self.wsdl.schemas allValues]) {
+        for (USBinding *binding in [schema.bindings allValues]) {
+            BOOL soap12 = [binding.soapVersion isEqualToString:@"1.2"];
+            NSString *soapNamespace = soap12 ? soap12Namespace : soap11Namespace;
+            NSData *fault = [self faultWithSoapNamespace:soapNamespace];
+
+            for (USOperation *operation in [binding.operations allValues]) {
+                NSMutableArray *parts = [NSMutableArray new];
+                for (USElement *part in operation.output.bodyParts) {
+                    NSString *partName = part.wsdlName ?: part.name;
+                    NSString *name = [part.type.prefix length]
+                        ? [NSString stringWithFormat:@"%@:%@", part.type.prefix, partName]
+                        : partName;
+                    [parts addObject:[self elementNamed:name type:part.type depth:0]];
+                }
+
+                USStandInRoute *route = [USStandInRoute new];
+                route.response = [self envelopeWithBodyChildren:parts soapNamespace:soapNamespace];
+                route.fault = fault;
+                route.contentType = soap12 ? @"application/soap+xml; charset=utf-8" : @"text/xml; charset=utf-8";
+
+                if ([operation.soapAction length])
+                    self.routesByAction[operation.soapAction] = route;
+                USElement *input = [operation.input.bodyParts firstObject];
+                if (input.wsdlName)
+                    self.routesByElement[input.wsdlName] = route;
+                NSLog(@"%@: %lu byte response", operation.name, (unsigned long)[route.response length]);
+            }
+        }
+    }
+}
+
+#pragma mark HTTP
+
+- (BOOL)listenOnPort:(uint16_t)port error:(NSError **)error {
+    [self buildRoutes];
+
+    // Clients going away mid-response must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&address, sizeof(address)) || listen(fd, SOMAXCONN)) {
+        if (error) *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        if (fd >= 0) close(fd);
+        return NO;
+    }
+
+    _acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t)fd, 0,
+                                           dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0));
+    dispatch_source_set_event_handler(_acceptSource, ^{
+        int client = accept(fd, NULL, NULL);
+        if (client < 0) return;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        // A thread per connection, so injected latency doesn't starve the dispatch pool
+        [NSThread detachNewThreadSelector:@selector(serveConnection:) toTarget:self withObject:@(client)];
+    });
+    dispatch_resume(_acceptSource);
+    return YES;
+}
+
+- (USStandInRoute *)routeForHeaders:(NSDictionary *)headers body:(NSData *)body {
+    NSCharacterSet *quotes = [NSCharacterSet characterSetWithCharactersInString:@"\""];
+    NSString *action = [headers[@"soapaction"] stringByTrimmingCharactersInSet:quotes];
+    if (!action) {
+        // SOAP 1.2 carries the action as a parameter of the content type
+        for (NSString *parameter in [headers[@"content-type"] componentsSeparatedByString:@";"]) {
+            NSString *trimmed = [parameter stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+            if ([trimmed hasPrefix:@"action="])
+                action = [[trimmed substringFromIndex:7] stringByTrimmingCharactersInSet:quotes];
+        }
+    }
+
+    USStandInRoute *route = action ? self.routesByAction[action] : nil;
+    if (route) return route;
+
+    NSXMLDocument *document = [[NSXMLDocument alloc] initWithData:body options:0 error:nil];
+    for (NSXMLElement *child in [[document rootElement] children]) {
+        if ([child kind] == NSXMLElementKind && [[child localName] isEqualToString:@"Body"]) {
+            for (NSXMLNode *part in [child children]) {
+                if ([part kind] == NSXMLElementKind)
+                    return self.routesByElement[[part localName]];
+            }
+        }
+    }
+    return nil;
+}
+
+- (BOOL)writeBody:(NSData *)body status:(NSString *)status contentType:(NSString *)contentType toSocket:(int)fd {
+    NSMutableString *head = [NSMutableString stringWithFormat:@"HTTP/1.1 %@\r\nContent-Type: %@\r\n", status, contentType];
+    if (self.chunkSize)
+        [head appendString:@"Transfer-Encoding: chunked\r\n\r\n"];
+    else
+        [head appendFormat:@"Content-Length: %lu\r\n\r\n", (unsigned long)[body length]];
+    NSData *headData = [head dataUsingEncoding:NSUTF8StringEncoding];
+    if (!writeAll(fd, [headData bytes], [headData length])) return NO;
+
+    if (!self.chunkSize)
+        return writeAll(fd, [body bytes], [body length]);
+
+    const uint8_t *bytes = [body bytes];
+    for (NSUInteger offset = 0; offset < [body length]; offset += self.chunkSize) {
+        NSUInteger length = MIN(self.chunkSize, [body length] - offset);
+        char size[32];
+        int sizeLength = snprintf(size, sizeof(size), "%lx\r\n", (unsigned long)length);
+        if (!writeAll(fd, size, (size_t)sizeLength) || !writeAll(fd, bytes + offset, length) || !writeAll(fd, "\r\n", 2))
+            return NO;
+    }
+    return writeAll(fd, "0\r\n\r\n", 5);
+}
+
+// Reads a line ending in CRLF which starts at offset, and returns it without the CRLF
+static NSString *readLine(int fd, NSMutableData *buffer, NSUInteger *offset) {
+    NSData *crlf = [NSData dataWithBytes:"\r\n" length:2];
+    NSRange end;
+    while ((end = [buffer rangeOfData:crlf options:0 range:NSMakeRange(*offset, [buffer length] - *offset)]).location == NSNotFound) {
+        if (!readMore(fd, buffer)) return nil;
+    }
+    NSString *line = [[NSString alloc] initWithBytes:(const char *)[buffer bytes] + *offset
+                                              length:end.location - *offset
+                                            encoding:NSISOLatin1StringEncoding];
+    *offset = NSMaxRange(end);
+    return line;
+}
+
+// Decodes a chunked body which starts at offset, and sets offset to the end
+// of the trailer; nil if the connection closed or the encoding is malformed
+static NSData *readChunkedBody(int fd, NSMutableData *buffer, NSUInteger *offset) {
+    NSMutableData *body = [NSMutableData new];
+    for (;;) {
+        NSString *sizeLine = readLine(fd, buffer, offset);
+        if (!sizeLine) return nil;
+        const char *digits = [sizeLine UTF8String];
+        char *end;
+        unsigned long long size = strtoull(digits, &end, 16);
+        if (end == digits || (*end && *end != ';' && *end != ' ' && *end != '\t')) return nil;
+        if (size == 0) break;
+        if (size > NSUIntegerMax - *offset - 2) return nil;
+
+        while ([buffer length] < *offset + size + 2) {
+            if (!readMore(fd, buffer)) return nil;
+        }
+        const char *bytes = (const char *)[buffer bytes] + *offset;
+        if (memcmp(bytes + size, "\r\n", 2)) return nil;
+        [body appendBytes:bytes length:(NSUInteger)size];
+        *offset += (NSUInteger)size + 2;
+    }
+
+    // Trailer fields, up to an empty line
+    for (;;) {
+        NSString *line = readLine(fd, buffer, offset);
+        if (!line) return nil;
+        if (![line length]) return body;
+    }
+}
+
+// Serves requests on one keep-alive connection until the client closes it.
+// Request bodies have a Content-Length or are chunked.
+- (void)serveConnection:(NSNumber *)socket {
+    int fd = [socket intValue];
+    NSMutableData *buffer = [NSMutableData new];
+    NSData *separator = [NSData dataWithBytes:"\r\n\r\n" length:4];
+
+    for (BOOL keepAlive = YES; keepAlive; ) {
+        @autoreleasepool {
+            NSRange headerEnd;
+            while ((headerEnd = [buffer rangeOfData:separator options:0 range:NSMakeRange(0, [buffer length])]).location == NSNotFound) {
+                if (!readMore(fd, buffer)) {
+                    close(fd);
+                    return;
+                }
+            }
+
+            NSString *head = [[NSString alloc] initWithBytes:[buffer bytes] length:headerEnd.location encoding:NSISOLatin1StringEncoding];
+            NSArray *lines = [head componentsSeparatedByString:@"\r\n"];
+            NSMutableDictionary *headers = [NSMutableDictionary new];
+            for (NSString *line in [lines subarrayWithRange:NSMakeRange(1, [lines count] - 1)]) {
+                NSRange colon = [line rangeOfString:@":"];
+                if (colon.location == NSNotFound) continue;
+                headers[[[line substringToIndex:colon.location] lowercaseString]] =
+                    [[line substringFromIndex:NSMaxRange(colon)] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+            }
+
+            NSUInteger bodyStart = NSMaxRange(headerEnd);
+            NSData *body;
+            NSUInteger bodyEnd;
+            NSString *transferEncoding = [headers[@"transfer-encoding"] lowercaseString];
+            if ([transferEncoding length] && ![transferEncoding isEqualToString:@"identity"]) {
+                bodyEnd = bodyStart;
+                if (![transferEncoding isEqualToString:@"chunked"] || !(body = readChunkedBody(fd, buffer, &bodyEnd))) {
+                    // The end of the body can't be found, so neither can the next request
+                    [self writeBody:[NSData data] status:@"400 Bad Request" contentType:@"text/plain" toSocket:fd];
+                    close(fd);
+                    return;
+                }
+            }
+            else {
+                NSUInteger bodyLength = (NSUInteger)MAX([headers[@"content-length"] integerValue], 0);
+                while ([buffer length] < bodyStart + bodyLength) {
+                    if (!readMore(fd, buffer)) {
+                        close(fd);
+                        return;
+                    }
+                }
+                body = [buffer subdataWithRange:NSMakeRange(bodyStart, bodyLength)];
+                bodyEnd = bodyStart + bodyLength;
+            }
+            [buffer replaceBytesInRange:NSMakeRange(0, bodyEnd) withBytes:NULL length:0];
+            keepAlive = ![[headers[@"connection"] lowercaseString] isEqualToString:@"close"];
+
+            if (self.latency > 0)
+                [NSThread sleepForTimeInterval:self.latency];
+
+            USStandInRoute *route = [self routeForHeaders:headers body:body];
+            BOOL written;
+            if (!route)
+                written = [self writeBody:[NSData data] status:@"404 Not Found" contentType:@"text/plain" toSocket:fd];
+            else if (self.faultRate > 0 && arc4random_uniform(1000000) < self.faultRate * 1000000)
+                written = [self writeBody:route.fault status:@"500 Internal Server Error" contentType:route.contentType toSocket:fd];
+            else
+                written = [self writeBody:route.response status:@"200 OK" contentType:route.contentType toSocket:fd];
+            if (!written) keepAlive = NO;
+        }
+    }
+    close(fd);
+}
+@end
@@ -22,14 +22,26 @@
 
 #import <Foundation/Foundation.h>
 
+#import "USCoding.h"
+
 @class USSchema;
 @class USType;
 
-@interface USWSDL : NSObject
+@interface USWSDL : NSObject <USCoding>
 @property (nonatomic, strong) NSMutableDictionary *schemas;
 @property (nonatomic, strong) USSchema *targetNamespace;
 
 - (USSchema *)createSchemaForNamespace:(NSString *)xmlNS prefix:(NSString *)prefix;
 - (USSchema *)schemaForPrefix:(NSString *)prefix;
 - (NSDictionary *)templateKeyDictionary;
+
+// Replace every reference to a USProxyType with the type it stands in for, so
+// that nothing after parsing goes through message forwarding. References which
+// never resolved are logged and fall back to xsd:string.
+- (void)collapseProxies;
+
+// Class names of every type which can appear in a message of one of the
+// services, plus the types named in keepTypes (by class name or schema name)
+// and everything they reference. Returns nil if there are no services.
+- (NSSet *)reachableTypeClassNamesKeeping:(NSArray *)keepTypes;
 @end
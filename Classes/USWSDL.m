@@ -25,13 +25,73 @@
 #import "USWSDL.h"
 
 #import "USAttribute.h"
+#import "USBinding.h"
+#import "USElement.h"
+#import "USMessage.h"
+#import "USOperation.h"
+#import "USOperationInterface.h"
+#import "USPort.h"
+#import "USQName.h"
 #import "USSchema.h"
+#import "USService.h"
+#import "USType.h"
 
 @interface USWSDL ()
 @property (nonatomic, strong) NSMutableDictionary *schemaPrefixes;
 @end
 
 @implementation USWSDL
+// The primitive types of the XML Schema namespace. These are never modified
+// once created, so every USWSDL in the process shares the same instances.
++ (NSDictionary *)builtinXSDTypes {
+    static NSDictionary *builtinTypes;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        NSDictionary *representations = @{
+            @"boolean": @"NSNumber *",
+            @"byte": @"NSNumber *",
+            @"int": @"NSNumber *",
+            @"integer": @"NSNumber *",
+            @"nonNegativeInteger": @"NSNumber *",
+            @"positiveInteger": @"NSNumber *",
+            @"unsignedByte": @"NSNumber *",
+            @"unsignedInt": @"NSNumber *",
+            @"unsignedLong": @"NSNumber *",
+            @"unsignedShort": @"NSNumber *",
+            @"double": @"NSNumber *",
+            @"long": @"NSNumber *",
+            @"short": @"NSNumber *",
+            @"float": @"NSNumber *",
+            @"dateTime": @"NSDate *",
+            @"date": @"NSDate *",
+            @"time": @"NSDate *",
+            @"duration": @"NSDate *",
+            @"base64Binary": @"NSData *",
+            @"decimal": @"NSDecimalNumber *",
+            @"QName": @"NSString *",
+            @"anyURI": @"NSString *",
+            @"string": @"NSString *",
+            @"normalizedString": @"NSString *",
+            @"token": @"NSString *",
+            @"language": @"NSString *",
+            @"Name": @"NSString *",
+            @"NCName": @"NSString *",
+            @"anyType": @"NSString *",
+            @"ID": @"NSString *",
+            @"ENTITY": @"NSString *",
+            @"IDREF": @"NSString *",
+            @"NMTOKEN": @"NSString *",
+        };
+
+        NSMutableDictionary *types = [NSMutableDictionary new];
+        [representations enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSString *representation, BOOL *stop) {
+            types[name] = [USType primitiveTypeWithName:name prefix:@"xsd" type:representation];
+        }];
+        builtinTypes = types;
+    });
+    return builtinTypes;
+}
+
 - (id)init {
 	if (!(self = [super init])) return nil;
 
@@ -39,39 +99,8 @@
     self.schemaPrefixes = [NSMutableDictionary new];
 
     USSchema *xsd = [self createSchemaForNamespace:@"http://www.w3.org/2001/XMLSchema" prefix:@"xsd"];
-	[xsd addSimpleClassWithName:@"boolean" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"byte" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"int" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"integer" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"nonNegativeInteger" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"positiveInteger" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"unsignedByte" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"unsignedInt" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"unsignedLong" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"unsignedShort" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"double" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"long" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"short" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"float" representationClass:@"NSNumber *"];
-	[xsd addSimpleClassWithName:@"dateTime" representationClass:@"NSDate *"];
-	[xsd addSimpleClassWithName:@"date" representationClass:@"NSDate *"];
-	[xsd addSimpleClassWithName:@"time" representationClass:@"NSDate *"];
-	[xsd addSimpleClassWithName:@"duration" representationClass:@"NSDate *"];
-	[xsd addSimpleClassWithName:@"base64Binary" representationClass:@"NSData *"];
-	[xsd addSimpleClassWithName:@"decimal" representationClass:@"NSDecimalNumber *"];
-	[xsd addSimpleClassWithName:@"QName" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"anyURI" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"string" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"normalizedString" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"token" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"language" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"Name" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"NCName" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"anyType" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"ID" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"ENTITY" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"IDREF" representationClass:@"NSString *"];
-	[xsd addSimpleClassWithName:@"NMTOKEN" representationClass:@"NSString *"];
+    for (USType *type in [[USWSDL builtinXSDTypes] allValues])
+        [xsd registerType:type];
 
     USSchema *xml = [self createSchemaForNamespace:@"http://www.w3.org/XML/1998/namespace" prefix:@"xml"];
     USAttribute *attr = [USAttribute new];
@@ -104,4 +133,131 @@
     return @{@"schemas": [self.schemas allValues]};
 }
 
+- (void)collapseProxies {
+    static NSString *const kindNames[USSymbolKindCount] = {
+        @"type", @"element", @"attribute", @"attribute group", @"message", @"port type", @"binding"
+    };
+
+    for (USSchema *schema in [self.schemas allValues]) {
+        for (USQName *symbol in [schema unresolvedSymbols]) {
+            for (NSUInteger kind = 0; kind < USSymbolKindCount; ++kind) {
+                if ([symbol pendingFixupCountOfKind:kind])
+                    NSLog(@"Unable to find %@ %@", kindNames[kind], symbol);
+            }
+        }
+    }
+
+    USType *fallback = [self.schemas[@"http://www.w3.org/2001/XMLSchema"] types][@"string"];
+    NSHashTable *reported = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality];
+    USType *(^resolve)(USType *) = ^(USType *type) {
+        // Only ask the proxy for its own properties, as anything else would be forwarded
+        while ([type isProxy]) {
+            USProxyType *proxy = (USProxyType *)type;
+            if (!proxy.type) {
+                if (![reported containsObject:proxy]) {
+                    [reported addObject:proxy];
+                    NSLog(@"Type %@ was never resolved; using xsd:string", proxy.typeName);
+                }
+                return fallback;
+            }
+            type = proxy.type;
+        }
+        return type;
+    };
+
+    // Named types which never resolved still need a class of their own
+    for (USSchema *schema in [self.schemas allValues]) {
+        for (NSString *name in [schema.types allKeys]) {
+            USProxyType *proxy = schema.types[name];
+            if ([proxy isProxy] && !proxy.type) {
+                NSLog(@"Base of type %@ was never resolved; deriving it from xsd:string", name);
+                proxy.type = [fallback deriveWithName:name prefix:schema.prefix];
+            }
+        }
+    }
+
+    for (USSchema *schema in [self.schemas allValues]) {
+        for (NSString *name in [schema.types allKeys])
+            schema.types[name] = resolve(schema.types[name]);
+    }
+
+    for (USSchema *schema in [self.schemas allValues]) {
+        for (USType *type in [schema.types allValues])
+            [type collapseProxies:resolve];
+        for (USElement *element in [schema.elements allValues])
+            [element collapseProxies:resolve];
+        for (USAttribute *attribute in [schema.attributes allValues])
+            [attribute collapseProxies:resolve];
+        for (NSArray *group in [schema.attributeGroups allValues]) {
+            for (USAttribute *attribute in group)
+                [attribute collapseProxies:resolve];
+        }
+        for (USMessage *message in [schema.messages allValues]) {
+            for (USElement *part in [message.parts allValues])
+                [part collapseProxies:resolve];
+        }
+    }
+}
+
+- (NSSet *)reachableTypeClassNamesKeeping:(NSArray *)keepTypes {
+    NSMutableArray *pending = [NSMutableArray new];
+    BOOL hasServices = NO;
+
+    void (^addElement)(USElement *) = ^(USElement *element) {
+        if (element.type)
+            [pending addObject:element.type];
+        for (USElement *substitution in element.substitutions) {
+            if (substitution.type)
+                [pending addObject:substitution.type];
+        }
+    };
+
+    for (USSchema *schema in [self.schemas allValues]) {
+        for (USService *service in [schema.services allValues]) {
+            hasServices = YES;
+            for (USPort *port in service.ports) {
+                for (USOperation *operation in [port.binding.operations allValues]) {
+                    for (USElement *element in operation.input.bodyParts) addElement(element);
+                    for (USElement *element in operation.input.headers) addElement(element);
+                    for (USElement *element in operation.output.bodyParts) addElement(element);
+                    for (USElement *element in operation.output.headers) addElement(element);
+                }
+            }
+        }
+
+        for (USType *type in [schema.types allValues]) {
+            if ([keepTypes containsObject:type.className] || [keepTypes containsObject:type.typeName])
+                [pending addObject:type];
+        }
+    }
+
+    if (!hasServices) return nil;
+
+    NSMutableSet *reachable = [NSMutableSet new];
+    while ([pending count]) {
+        USType *type = [pending lastObject];
+        [pending removeLastObject];
+
+        if ([reachable containsObject:type.className]) continue;
+        [reachable addObject:type.className];
+        [pending addObjectsFromArray:[type referencedTypes]];
+    }
+
+    return reachable;
+}
+
+
++ (NSArray *)codingKeys {
+    return @[@"schemas", @"targetNamespace", @"schemaPrefixes"];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    USEncodeKeys(self, coder, [[self class] codingKeys]);
+}
+
+- (id)initWithCoder:(NSCoder *)coder {
+    if ((self = [super init]))
+        USDecodeKeys(self, coder, [[self class] codingKeys]);
+    return self;
+}
 @end
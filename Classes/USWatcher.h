@@ -0,0 +1,37 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+// Watches a set of local files and directories and calls the handler on the
+// main queue with the URLs which changed. Changes arriving within a short
+// window of each other are delivered together, so that saving several files
+// at once only triggers one regeneration.
+@interface USWatcher : NSObject
+- (id)initWithHandler:(void (^)(NSSet *changedURLs))handler;
+
+// Replaces the set of watched URLs. Anything which isn't a local file is
+// ignored. Editors often save by replacing a file rather than writing to it,
+// which leaves a watch on the old file, so this should be called again with
+// the inputs of each regeneration.
+- (void)watchURLs:(NSArray *)urls;
+@end
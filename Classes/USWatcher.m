@@ -0,0 +1,110 @@
+/*
+ Copyright (c) 2013 7x7 Labs Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "USWatcher.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static const int64_t USWatcherCoalesceInterval = 100 * NSEC_PER_MSEC;
+
+// A vnode dispatch source on a single file, cancelled when released
+@interface USWatchedFile : NSObject
+- (id)initWithURL:(NSURL *)url handler:(dispatch_block_t)handler;
+@end
+
+@implementation USWatchedFile {
+    dispatch_source_t _source;
+}
+
+- (id)initWithURL:(NSURL *)url handler:(dispatch_block_t)handler {
+    if (!(self = [super init])) return nil;
+
+    int fd = open([[url path] fileSystemRepresentation], O_EVTONLY);
+    if (fd < 0) return nil;
+
+    _source = dispatch_source_create(DISPATCH_SOURCE_TYPE_VNODE, fd,
+                                     DISPATCH_VNODE_WRITE | DISPATCH_VNODE_EXTEND | DISPATCH_VNODE_DELETE | DISPATCH_VNODE_RENAME,
+                                     dispatch_get_main_queue());
+    if (!_source) {
+        close(fd);
+        return nil;
+    }
+
+    dispatch_source_set_event_handler(_source, handler);
+    dispatch_source_set_cancel_handler(_source, ^{ close(fd); });
+    dispatch_resume(_source);
+    return self;
+}
+
+- (void)dealloc {
+    dispatch_source_cancel(_source);
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_source);
+#endif
+}
+@end
+
+@interface USWatcher ()
+@property (nonatomic, copy) void (^handler)(NSSet *);
+@property (nonatomic, strong) NSArray *watchedFiles;
+@property (nonatomic, strong) NSMutableSet *pendingURLs;
+@end
+
+@implementation USWatcher
+- (id)initWithHandler:(void (^)(NSSet *))handler {
+    if ((self = [super init])) {
+        self.handler = handler;
+        self.watchedFiles = @[];
+        self.pendingURLs = [NSMutableSet new];
+    }
+    return self;
+}
+
+- (void)watchURLs:(NSArray *)urls {
+    NSMutableArray *watchedFiles = [NSMutableArray new];
+    for (NSURL *url in [NSSet setWithArray:[urls valueForKey:@"absoluteURL"]]) {
+        if (![url isFileURL]) continue;
+
+        USWatchedFile *file = [[USWatchedFile alloc] initWithURL:url handler:^{
+            [self fileChanged:url];
+        }];
+        if (file)
+            [watchedFiles addObject:file];
+        else
+            NSLog(@"Unable to watch %@", [url path]);
+    }
+    self.watchedFiles = watchedFiles;
+}
+
+- (void)fileChanged:(NSURL *)url {
+    BOOL scheduled = [self.pendingURLs count] > 0;
+    [self.pendingURLs addObject:url];
+    if (scheduled) return;
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, USWatcherCoalesceInterval), dispatch_get_main_queue(), ^{
+        NSSet *changed = [self.pendingURLs copy];
+        [self.pendingURLs removeAllObjects];
+        self.handler(changed);
+    });
+}
+@end
@@ -23,7 +23,33 @@
 #import <Foundation/Foundation.h>
 #import "USWSDL.h"
 
+@class USResourceCache;
+
 @interface USWriter : NSObject
 - (id)initWithWSDL:(USWSDL *)aWsdl outputDirectory:(NSURL *)anOutDir;
 - (void)write;
+
+// Write each type to its own <className>.h/.m pair, with <prefix>.h as an
+// umbrella header and <prefix>_Forward.h holding forward declarations.
+// Defaults to the splitTypes user default.
+@property (nonatomic) BOOL splitTypes;
+// If greater than one (and splitTypes is off), spread the type
+// implementations over this many <prefix>_<n>.m files. Defaults to the
+// shardCount user default.
+@property (nonatomic) NSUInteger shardCount;
+// Only write types which the services can send or receive. Defaults to the
+// pruneUnreachableTypes user default.
+@property (nonatomic) BOOL pruneUnreachableTypes;
+// Names of types to write even if pruning would drop them, e.g. subclasses
+// which only arrive through xsi:type. Defaults to the comma separated
+// keepTypes user default.
+@property (nonatomic, copy) NSArray *keepTypes;
+// If set, templates are read through this cache rather than from disk on
+// every expansion
+@property (nonatomic, strong) USResourceCache *resourceCache;
+
+// Names of the files generated by -write, relative to the output directory
+@property (nonatomic, readonly) NSSet *outputFiles;
+// File URLs of every template read by -write
+@property (nonatomic, readonly) NSArray *templateURLs;
 @end
@@ -30,6 +30,8 @@
 #import "USBinding.h"
 #import "USElement.h"
 #import "USPort.h"
+#import "USProfiler.h"
+#import "USResourceCache.h"
 #import "USSchema.h"
 #import "USService.h"
 #import "USType.h"
@@ -37,19 +39,68 @@
 @interface USWriter ()
 @property (nonatomic, copy) NSURL *outDir;
 @property (nonatomic, strong) USWSDL *wsdl;
+@property (nonatomic, strong) NSMutableSet *writtenFiles;
+@property (nonatomic, strong) NSMutableSet *usedTemplates;
+@property (nonatomic, strong) NSArray *shards;
+@property (nonatomic, strong) NSSet *reachableTypes;
+@property (nonatomic, strong) NSMutableSet *writtenSchemas;
+@property (nonatomic, strong) NSMutableSet *writtenTypes;
 @end
 
+// FNV-1a, so that a type lands in the same shard on every run
+static NSUInteger shardIndexForClassName(NSString *className, NSUInteger shardCount) {
+    uint32_t hash = 2166136261u;
+    for (const char *c = [className UTF8String]; *c; ++c)
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    return hash % shardCount;
+}
+
 @implementation USWriter
 - (id)initWithWSDL:(USWSDL *)aWsdl outputDirectory:(NSURL *)anOutDir {
     if ((self = [super init])) {
         self.wsdl = aWsdl;
         self.outDir = anOutDir;
+        self.writtenFiles = [NSMutableSet new];
+        self.usedTemplates = [NSMutableSet new];
+        self.writtenSchemas = [NSMutableSet new];
+        self.writtenTypes = [NSMutableSet new];
+
+        NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+        self.splitTypes = [defaults boolForKey:@"splitTypes"];
+        self.shardCount = (NSUInteger)MAX([defaults integerForKey:@"shardCount"], 0);
+        self.pruneUnreachableTypes = [defaults boolForKey:@"pruneUnreachableTypes"];
+
+        NSMutableArray *keepTypes = [NSMutableArray new];
+        for (NSString *name in [[defaults stringForKey:@"keepTypes"] componentsSeparatedByString:@","]) {
+            NSString *trimmed = [name stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+            if ([trimmed length])
+                [keepTypes addObject:trimmed];
+        }
+        self.keepTypes = keepTypes;
     }
 
     return self;
 }
 
+- (NSSet *)outputFiles {
+    return [self.writtenFiles copy];
+}
+
+- (NSArray *)templateURLs {
+    NSMutableArray *ret = [NSMutableArray new];
+    for (NSString *path in self.usedTemplates)
+        [ret addObject:[NSURL fileURLWithPath:path]];
+    return ret;
+}
+
 - (void)write {
+    self.reachableTypes = nil;
+    if (self.pruneUnreachableTypes) {
+        self.reachableTypes = [self.wsdl reachableTypeClassNamesKeeping:self.keepTypes];
+        if (!self.reachableTypes)
+            NSLog(@"No services found, writing all types");
+    }
+
     for (NSString *schema in self.wsdl.schemas)
         [self writeSchema:self.wsdl.schemas[schema]];
 
@@ -57,10 +108,10 @@
 }
 
 - (void)writeSchema:(USSchema *)schema {
-    if (schema.hasBeenWritten == YES) return;
+    if ([self.writtenSchemas containsObject:schema]) return;
     if (![schema shouldWrite]) return;
 
-    schema.hasBeenWritten = YES;
+    [self.writtenSchemas addObject:schema];
 
     // Write out any imports first so they can have a prefix generated for them if needed
     for (USSchema *import in schema.imports)
@@ -71,6 +122,15 @@
 
     [self append:schema toHString:hString mString:mString];
 
+    if (!self.splitTypes && self.shardCount > 1) {
+        NSString *preamble = [self expandTemplateAtPath:[schema templateFileMPath]
+                                                   keys:[self templateKeysForItem:schema]] ?: @"";
+        NSMutableArray *shards = [NSMutableArray arrayWithCapacity:self.shardCount];
+        for (NSUInteger i = 0; i < self.shardCount; ++i)
+            [shards addObject:[preamble mutableCopy]];
+        self.shards = shards;
+    }
+
     for (USType *type in [schema.types allValues])
         [self appendType:type toHString:hString mString:mString];
 
@@ -82,24 +142,47 @@
     }
 
     if ([hString length] > 0) {
-        NSError *error;
-        [hString writeToURL:[NSURL URLWithString:[schema.prefix stringByAppendingString:@".h"] relativeToURL:self.outDir]
-                 atomically:NO
-                   encoding:NSUTF8StringEncoding
-                      error:&error];
-
-        [mString writeToURL:[NSURL URLWithString:[schema.prefix stringByAppendingString:@".m"] relativeToURL:self.outDir]
-                 atomically:NO
-                   encoding:NSUTF8StringEncoding
-                      error:&error];
+        [self writeString:hString toFilename:[schema.prefix stringByAppendingString:@".h"]];
+        [self writeString:mString toFilename:[schema.prefix stringByAppendingString:@".m"]];
+
+        // Only per-type headers import this; shards import the umbrella header
+        if (self.splitTypes) {
+            NSString *forwardPath = [[NSBundle mainBundle] pathForTemplateNamed:@"SchemaForward_H"];
+            [self writeString:[self expandTemplateAtPath:forwardPath keys:[self templateKeysForItem:schema]]
+                   toFilename:[schema.prefix stringByAppendingString:@"_Forward.h"]];
+        }
+
+        [self.shards enumerateObjectsUsingBlock:^(NSString *shard, NSUInteger i, BOOL *stop) {
+            [self writeString:shard toFilename:[NSString stringWithFormat:@"%@_%lu.m", schema.prefix, (unsigned long)i]];
+        }];
     }
+
+    self.shards = nil;
+}
+
+// Leaves the file alone if it already has exactly these contents, so that
+// unchanged outputs keep their timestamps and don't trigger a recompile
+- (void)writeString:(NSString *)contents toFilename:(NSString *)fileName {
+    if (!contents) return;
+
+    [self.writtenFiles addObject:fileName];
+
+    uint64_t start = USProfilerBegin(USProfilerPhaseFileOutput);
+    NSURL *url = [NSURL URLWithString:fileName relativeToURL:self.outDir];
+    NSData *data = [contents dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *existing = [NSData dataWithContentsOfURL:url];
+    NSError *error;
+    if (![existing isEqualToData:data] && ![data writeToURL:url options:0 error:&error])
+        NSLog(@"Unable to write %@: %@", fileName, error);
+    USProfilerEnd(USProfilerPhaseFileOutput, start);
 }
 
 - (void)appendType:(USType *)type toHString:(NSMutableString *)hString mString:(NSMutableString *)mString
 {
-    if (type.hasBeenWritten) return;
+    if ([self.writtenTypes containsObject:type]) return;
+    if (self.reachableTypes && ![self.reachableTypes containsObject:type.className]) return;
 
-    type.hasBeenWritten = YES;
+    [self.writtenTypes addObject:type];
 
     USComplexType *complexType = [type asComplex];
     if (complexType) {
@@ -118,35 +201,100 @@
                 [self appendType:attribute.type toHString:hString mString:mString];
         }
     }
+    else {
+        // e.g. the base of a derived primitive, which it subclasses
+        for (USType *referenced in [type referencedTypes]) {
+            if (![referenced asComplex])
+                [self appendType:referenced toHString:hString mString:mString];
+        }
+    }
     
-    [self append:type toHString:hString mString:mString];
+    if (self.splitTypes)
+        [self writeFilesForType:type toHString:hString];
+    else if (self.shards)
+        [self append:type toHString:hString mString:self.shards[shardIndexForClassName(type.className, self.shards.count)]];
+    else
+        [self append:type toHString:hString mString:mString];
 }
 
-- (void)append:(id)item toHString:(NSMutableString *)hString mString:(NSMutableString *)mString {
+// Writes the interface and implementation of a type to files of their own
+// and imports the header from the schema's umbrella header. The header only
+// imports what the interface needs (superclass and non-object member types),
+// so that editing one type doesn't recompile every other type's file.
+- (void)writeFilesForType:(USType *)type toHString:(NSMutableString *)hString {
+    NSString *header = [type.className stringByAppendingString:@".h"];
+    NSString *superClassName = [type asComplex].superClass.className;
+
+    NSMutableOrderedSet *headerImports = [NSMutableOrderedSet new];
+    NSMutableOrderedSet *implementationImports = [NSMutableOrderedSet new];
+    for (USType *referenced in [type referencedTypes]) {
+        NSString *referencedHeader = [referenced.className stringByAppendingString:@".h"];
+        if ([referencedHeader isEqualToString:header]) continue;
+
+        [implementationImports addObject:referencedHeader];
+        if (![referenced asComplex] || [referenced.className isEqualToString:superClassName])
+            [headerImports addObject:referencedHeader];
+        else if (![referenced.prefix isEqualToString:type.prefix])
+            [headerImports addObject:[referenced.prefix stringByAppendingString:@"_Forward.h"]];
+    }
+
+    NSMutableDictionary *templateKeys = [self templateKeysForItem:type];
+    templateKeys[@"typeHeader"] = header;
+    templateKeys[@"headerImports"] = [headerImports array];
+    templateKeys[@"implementationImports"] = [implementationImports array];
+
+    NSBundle *bundle = [NSBundle mainBundle];
+    NSString *hPreamble = [self expandTemplateAtPath:[bundle pathForTemplateNamed:@"TypeHeader_H"] keys:templateKeys];
+    NSString *mPreamble = [self expandTemplateAtPath:[bundle pathForTemplateNamed:@"Schema_M"] keys:templateKeys];
+    NSString *hBody = [self expandTemplateAtPath:[type templateFileHPath] keys:templateKeys];
+    NSString *mBody = [self expandTemplateAtPath:[type templateFileMPath] keys:templateKeys];
+    if (!hPreamble || !mPreamble || !hBody || !mBody) return;
+
+    [self writeString:[hPreamble stringByAppendingString:hBody] toFilename:header];
+    [self writeString:[mPreamble stringByAppendingString:mBody]
+           toFilename:[type.className stringByAppendingString:@".m"]];
+    [hString appendFormat:@"#import \"%@\"\n", header];
+}
+
+- (NSMutableDictionary *)templateKeysForItem:(id)item {
     NSMutableDictionary *templateKeys = [[item templateKeyDictionary] mutableCopy];
     templateKeys[@"wsdl"] = [self.wsdl templateKeyDictionary];
+    return templateKeys;
+}
 
-    NSArray *errors;
-    NSString *newHString = [NSString stringByExpandingTemplateAtPath:[item templateFileHPath]
-                                                     usingDictionary:templateKeys
-                                                            encoding:NSUTF8StringEncoding
-                                                      errorsReturned:&errors];
+- (NSString *)expandTemplateAtPath:(NSString *)path keys:(NSDictionary *)templateKeys {
+    if (path)
+        [self.usedTemplates addObject:path];
 
-    if (errors == nil)
-        [hString appendString:newHString];
+    NSArray *errors;
+    uint64_t start = USProfilerBegin(USProfilerPhaseTemplateExpansion);
+    NSString *template = [self.resourceCache stringWithContentsOfFile:path];
+    NSString *ret;
+    if (template)
+        ret = [NSString stringByExpandingTemplate:template usingDictionary:templateKeys errorsReturned:&errors];
     else
-        NSLog(@"Errors encountered generating header: %@", errors);
+        ret = [NSString stringByExpandingTemplateAtPath:path
+                                        usingDictionary:templateKeys
+                                               encoding:NSUTF8StringEncoding
+                                         errorsReturned:&errors];
+    USProfilerEnd(USProfilerPhaseTemplateExpansion, start);
+    if (errors) {
+        NSLog(@"Errors encountered expanding %@: %@", [path lastPathComponent], errors);
+        return nil;
+    }
+    return ret;
+}
 
-    NSString *newMString = [NSString stringByExpandingTemplateAtPath:[item templateFileMPath]
-                                                     usingDictionary:templateKeys
-                                                            encoding:NSUTF8StringEncoding
-                                                      errorsReturned:&errors];
+- (void)append:(id)item toHString:(NSMutableString *)hString mString:(NSMutableString *)mString {
+    NSMutableDictionary *templateKeys = [self templateKeysForItem:item];
 
-    if (errors == nil)
-        [mString appendString:newMString];
-    else
-        NSLog(@"Errors encountered while generating implementation: %@", errors);
+    NSString *newHString = [self expandTemplateAtPath:[item templateFileHPath] keys:templateKeys];
+    if (newHString)
+        [hString appendString:newHString];
 
+    NSString *newMString = [self expandTemplateAtPath:[item templateFileMPath] keys:templateKeys];
+    if (newMString)
+        [mString appendString:newMString];
 }
 
 - (void)copyStandardFilesToOutputDirectory {
@@ -163,15 +311,41 @@
     // Copy globals
     [self writeResourceName:@"USGlobals_H" toFilename:@"USGlobals.h"];
     [self writeResourceName:@"USGlobals_M" toFilename:@"USGlobals.m"];
+
+    // Copy binary snapshot support
+    [self writeResourceName:@"USSnapshot_H" toFilename:@"USSnapshot.h"];
+    [self writeResourceName:@"USSnapshot_M" toFilename:@"USSnapshot.m"];
+
+    // Copy call policies
+    [self writeResourceName:@"USCallPolicy_H" toFilename:@"USCallPolicy.h"];
+    [self writeResourceName:@"USCallPolicy_M" toFilename:@"USCallPolicy.m"];
+
+    // Copy request body streaming
+    [self writeResourceName:@"USRequestBody_H" toFilename:@"USRequestBody.h"];
+    [self writeResourceName:@"USRequestBody_M" toFilename:@"USRequestBody.m"];
+
+    // Copy the response cache
+    [self writeResourceName:@"USResponseCache_H" toFilename:@"USResponseCache.h"];
+    [self writeResourceName:@"USResponseCache_M" toFilename:@"USResponseCache.m"];
+
+    // Copy transports
+    [self writeResourceName:@"USTransport_H" toFilename:@"USTransport.h"];
+    [self writeResourceName:@"USTransport_M" toFilename:@"USTransport.m"];
+
+    // Copy the load driver, only wanted by load tests
+    if ([[NSUserDefaults standardUserDefaults] boolForKey:@"loadDriver"]) {
+        [self writeResourceName:@"USLoadDriver_H" toFilename:@"USLoadDriver.h"];
+        [self writeResourceName:@"USLoadDriver_M" toFilename:@"USLoadDriver.m"];
+    }
 }
 
 - (void)writeResourceName:(NSString *)resourceName toFilename:(NSString *)fileName {
     NSString *path = [[NSBundle mainBundle] pathForTemplateNamed:resourceName];
-    NSString *resourceContents = [NSString stringWithContentsOfFile:path usedEncoding:nil error:nil];
-    [resourceContents writeToURL:[NSURL URLWithString:fileName relativeToURL:self.outDir]
-                      atomically:NO
-                        encoding:NSUTF8StringEncoding
-                           error:nil];
+    if (path)
+        [self.usedTemplates addObject:path];
+    NSString *resourceContents = [self.resourceCache stringWithContentsOfFile:path]
+        ?: [NSString stringWithContentsOfFile:path usedEncoding:nil error:nil];
+    [self writeString:resourceContents toFilename:fileName];
 }
 
 @end
@@ -28,8 +28,10 @@
 + (USObjCKeywords *)sharedInstance
 {
     static USObjCKeywords *sharedInstance = nil;
-	if (sharedInstance == nil)
-		sharedInstance = [USObjCKeywords new];
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        sharedInstance = [USObjCKeywords new];
+    });
 	return sharedInstance;
 }
 
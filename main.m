@@ -22,22 +22,225 @@
 
 #import <Foundation/Foundation.h>
 #import "USParserApplication.h"
+#import "USManifest.h"
+#import "USModelCache.h"
+#import "USProfiler.h"
+#import "USResourceCache.h"
+#import "USStandInServer.h"
+#import "USWatcher.h"
+
+// Parses one WSDL and writes its code into outURL. Returns NO if the WSDL
+// couldn't be parsed. If inputURLs is given, it's set to the documents and
+// templates the generated code depends on.
+static BOOL generate(USParserApplication *parserApp, NSURL *wsdlURL, NSURL *outURL, USResourceCache *cache,
+                     NSArray **inputURLs)
+{
+    USManifest *manifest = nil;
+    if ([[NSUserDefaults standardUserDefaults] boolForKey:@"incremental"]) {
+        manifest = [[USManifest alloc] initWithOutputDirectory:outURL];
+        if ([manifest isUpToDate]) {
+            NSLog(@"Generated code in %@ is up to date", outURL);
+            if (inputURLs)
+                *inputURLs = [manifest inputURLs];
+            return YES;
+        }
+    }
+
+    USModelCache *modelCache = nil;
+    NSString *modelCachePath = [[[NSUserDefaults standardUserDefaults] stringForKey:@"modelCache"] stringByExpandingTildeInPath];
+    if (modelCachePath)
+        modelCache = [[USModelCache alloc] initWithDirectory:[NSURL fileURLWithPath:modelCachePath isDirectory:YES]];
+
+    NSArray *documentURLs = nil;
+    USWSDL *wsdl = [modelCache modelForURL:wsdlURL documentURLs:&documentURLs];
+    if (wsdl)
+        NSLog(@"Using cached model of %@", wsdlURL);
+    else {
+        NSLog(@"Parsing WSDL from %@", wsdlURL);
+
+        USParser *parser = [[USParser alloc] initWithURL:wsdlURL];
+        parser.resourceCache = cache;
+        wsdl = [parser parse];
+        documentURLs = parser.documentURLs;
+        [modelCache storeModel:wsdl forURL:wsdlURL documentURLs:documentURLs];
+    }
+
+    // Leave the previous output and manifest alone, as the writer and the
+    // manifest's sweep of stale outputs would otherwise delete all of it
+    if (!wsdl) {
+        NSLog(@"Unable to parse %@; nothing was generated", wsdlURL);
+        if (inputURLs)
+            *inputURLs = [documentURLs count] ? documentURLs : @[wsdlURL];
+        return NO;
+    }
+
+    [parserApp writeDebugInfoForWSDL:wsdl];
+
+    NSLog(@"Generating Objective-C code into %@", outURL);
+    USWriter *writer = [[USWriter alloc] initWithWSDL:wsdl outputDirectory:outURL];
+    writer.resourceCache = cache;
+    [writer write];
+
+    NSArray *inputs = [documentURLs arrayByAddingObjectsFromArray:writer.templateURLs];
+    [manifest recordInputs:inputs outputs:writer.outputFiles];
+    if (inputURLs)
+        *inputURLs = inputs;
+
+    return YES;
+}
+
+// Stays resident after the first run and regenerates whenever the WSDL, a
+// document it imports or a template changes. Documents and templates are kept
+// in memory between runs and only the changed ones are read again; outputs
+// whose contents didn't change aren't rewritten. Never returns.
+static void watch(USParserApplication *parserApp, NSArray *inputURLs, USResourceCache *cache)
+{
+    NSURL *wsdlURL = parserApp.wsdlURL;
+    NSURL *outURL = parserApp.outURL;
+
+    // A template added to the template directory overrides the built-in one
+    NSMutableArray *extraURLs = [NSMutableArray new];
+    NSString *templateDirectory = [[NSUserDefaults standardUserDefaults] stringForKey:@"templateDirectory"];
+    if (templateDirectory)
+        [extraURLs addObject:[NSURL fileURLWithPath:[templateDirectory stringByExpandingTildeInPath] isDirectory:YES]];
+
+    __block USWatcher *watcher = [[USWatcher alloc] initWithHandler:^(NSSet *changedURLs) {
+        @autoreleasepool {
+            NSLog(@"Changed: %@", [[[changedURLs allObjects] valueForKey:@"lastPathComponent"] componentsJoinedByString:@", "]);
+            [cache invalidateURLs:changedURLs];
+
+            NSArray *inputs = nil;
+            NSDate *start = [NSDate date];
+            generate(parserApp, wsdlURL, outURL, cache, &inputs);
+            NSLog(@"Regenerated in %.2fs", -[start timeIntervalSinceNow]);
+
+            [watcher watchURLs:[inputs ?: @[] arrayByAddingObjectsFromArray:extraURLs]];
+        }
+    }];
+    [watcher watchURLs:[inputURLs ?: @[] arrayByAddingObjectsFromArray:extraURLs]];
+
+    NSLog(@"Watching %@ for changes", wsdlURL);
+    dispatch_main();
+}
+
+// Runs every job listed in the batch manifest, a plist array of dictionaries
+// with wsdlPath and outPath keys (relative paths are relative to the
+// manifest), in parallel. The jobs share one resource cache, so templates and
+// documents imported by several WSDLs are only read once.
+static int generateBatch(USParserApplication *parserApp, NSString *manifestPath, BOOL serial)
+{
+    NSArray *jobs = [NSArray arrayWithContentsOfFile:manifestPath];
+    if (!jobs) {
+        NSLog(@"Unable to read batch manifest %@", manifestPath);
+        return 1;
+    }
+
+    NSURL *baseURL = [NSURL fileURLWithPath:[manifestPath stringByDeletingLastPathComponent] isDirectory:YES];
+    USResourceCache *cache = [USResourceCache new];
+    NSOperationQueue *queue = [NSOperationQueue new];
+    if (serial)
+        queue.maxConcurrentOperationCount = 1;
+
+    __block int failures = 0;
+    for (NSDictionary *job in jobs) {
+        NSString *wsdlPath = [job[@"wsdlPath"] stringByExpandingTildeInPath];
+        NSString *outPath = [job[@"outPath"] stringByExpandingTildeInPath];
+        if (![wsdlPath length] || ![outPath length]) {
+            NSLog(@"Skipping batch job without a wsdlPath and outPath: %@", job);
+            ++failures;
+            continue;
+        }
+
+        NSURL *wsdlURL = [NSURL URLWithString:wsdlPath];
+        if (![wsdlURL scheme])
+            wsdlURL = [NSURL fileURLWithPath:wsdlPath relativeToURL:baseURL];
+        NSURL *outURL = [[NSURL fileURLWithPath:outPath isDirectory:YES relativeToURL:baseURL] absoluteURL];
+        [[NSFileManager defaultManager] createDirectoryAtURL:outURL withIntermediateDirectories:YES
+                                                  attributes:nil error:nil];
+
+        [queue addOperationWithBlock:^{
+            @autoreleasepool {
+                if (!generate(parserApp, wsdlURL, outURL, cache, NULL)) {
+                    @synchronized (queue) {
+                        ++failures;
+                    }
+                }
+            }
+        }];
+    }
+
+    [queue waitUntilAllOperationsAreFinished];
+    if (failures)
+        NSLog(@"%d of %lu batch jobs failed", failures, (unsigned long)[jobs count]);
+    return failures ? 1 : 0;
+}
+
+// Parses the WSDL and answers its operations with synthetic responses on the
+// given loopback port until killed. Never returns unless listening fails.
+static int standIn(USParserApplication *parserApp, uint16_t port)
+{
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+
+    NSLog(@"Parsing WSDL from %@", parserApp.wsdlURL);
+    USWSDL *wsdl = [[[USParser alloc] initWithURL:parserApp.wsdlURL] parse];
+    if (!wsdl)
+        return 1;
+
+    USStandInServer *server = [[USStandInServer alloc] initWithWSDL:wsdl];
+    if ([defaults objectForKey:@"standInItems"])
+        server.itemCount = (NSUInteger)[defaults integerForKey:@"standInItems"];
+    if ([defaults objectForKey:@"standInDepth"])
+        server.maxDepth = (NSUInteger)[defaults integerForKey:@"standInDepth"];
+    if ([defaults objectForKey:@"standInStringLength"])
+        server.stringLength = (NSUInteger)[defaults integerForKey:@"standInStringLength"];
+    server.latency = [defaults doubleForKey:@"standInLatency"] / 1000.0;
+    server.faultRate = [defaults doubleForKey:@"standInFaultRate"];
+    server.chunkSize = (NSUInteger)[defaults integerForKey:@"standInChunkSize"];
+
+    NSError *error = nil;
+    if (![server listenOnPort:port error:&error]) {
+        NSLog(@"Unable to listen on port %u: %@", port, error);
+        return 1;
+    }
+
+    NSLog(@"Serving %@ on http://127.0.0.1:%u/", parserApp.wsdlURL, port);
+    dispatch_main();
+}
 
 int main(int argc, char *argv[])
 {
     @autoreleasepool {
         USParserApplication *parserApp = [USParserApplication new];
 
-        if (parserApp.wsdlURL == nil) {
+        NSString *batchManifest = [[NSUserDefaults standardUserDefaults] stringForKey:@"batchManifest"];
+        if (parserApp.wsdlURL == nil && batchManifest == nil) {
             NSString    *help = [NSString stringWithFormat:
                                  @"%@ %@, %@\n"
-                                 "Usage: %s -wsdlPath <url or path> [-outPath <path>] [-addTagToServiceName <YES or NO>] [-templateDirectory <path>] [-writeDebug <YES or NO>]\n"
+                                 "Usage: %s -wsdlPath <url or path> [-outPath <path>] | -batchManifest <path> [-addTagToServiceName <YES or NO>] [-templateDirectory <path>] [-writeDebug <YES or NO>] [-incremental <YES or NO>] [-splitTypes <YES or NO>] [-shardCount <n>] [-pruneUnreachableTypes <YES or NO>] [-keepTypes <names>] [-benchmarkReport <path>] [-watch <YES or NO>] [-modelCache <path>] [-scalarNumbers <YES or NO>] [-loadDriver <YES or NO>] [-standInPort <port> [-standInItems <n>] [-standInDepth <n>] [-standInStringLength <n>] [-standInLatency <ms>] [-standInFaultRate <0-1>] [-standInChunkSize <bytes>]]\n"
                                  "Generates ObjC classes able to perform SOAP requests defined by a WSDL file.\n"
                                  "    -wsdlPath <url or path>\t\tURL or path to a WSDL file\n"
                                  "    -outPath <path>\t\t\tDirectory output path. Defaults to current working directory\n"
+                                 "    -batchManifest <path>\t\tGenerate every job in a plist array of {wsdlPath, outPath} dictionaries, in parallel\n"
                                  "    -addTagToServiceName <YES or NO>\tSuffixes service name with 'Svc' (avoid name conflicts). Defaults to NO\n"
                                  "    -templateDirectory <path>\t\tPath of folder containing wsdl2objc templates. By default will look in */Application Support/wsdl2objc directories\n"
-                                 "    -writeDebug <YES or NO>\t\tWrite Write debug info for WSDL. Defaults to NO.",
+                                 "    -writeDebug <YES or NO>\t\tWrite Write debug info for WSDL. Defaults to NO.\n"
+                                 "    -incremental <YES or NO>\t\tSkip generation if the WSDL, its imports, the templates and options are unchanged since the last run, and remove stale outputs. Defaults to NO.\n"
+                                 "    -splitTypes <YES or NO>\t\tWrite each type to its own .h/.m pair, with <prefix>.h as umbrella header. Defaults to NO.\n"
+                                 "    -shardCount <n>\t\t\tSpread the type implementations of each schema over n files. Ignored with -splitTypes.\n"
+                                 "    -pruneUnreachableTypes <YES or NO>\tOnly generate types used by the services' operations. Defaults to NO.\n"
+                                 "    -keepTypes <names>\t\t\tComma separated types to generate even if unreachable, e.g. xsi:type subclasses\n"
+                                 "    -benchmarkReport <path>\t\tWrite phase timings and memory use as JSON to path\n"
+                                 "    -watch <YES or NO>\t\t\tKeep running and regenerate whenever the WSDL, its imports or the templates change. Defaults to NO.\n"
+                                 "    -modelCache <path>\t\t\tKeep parsed models in this directory and reuse them while the WSDL and its imports are unchanged\n"
+                                 "    -scalarNumbers <YES or NO>\t\tGenerate int32_t/int64_t/double/BOOL properties for numeric and boolean elements, with has<Name> for optional ones. Defaults to NO.\n"
+                                 "    -loadDriver <YES or NO>\t\tAlso write USLoadDriver, which keeps calls in flight for a fixed time and reports latency percentiles. Defaults to NO.\n"
+                                 "    -standInPort <port>\t\tInstead of generating, answer the WSDL's operations with synthetic responses on this loopback port\n"
+                                 "    -standInItems <n>\t\t\tItems in each repeated element of a stand-in response. Defaults to 10\n"
+                                 "    -standInDepth <n>\t\t\tNesting depth of stand-in responses. Defaults to 8\n"
+                                 "    -standInStringLength <n>\t\tLength of stand-in string values. Defaults to 16\n"
+                                 "    -standInLatency <ms>\t\tDelay before each stand-in response\n"
+                                 "    -standInFaultRate <0-1>\t\tFraction of stand-in responses which are SOAP faults\n"
+                                 "    -standInChunkSize <bytes>\t\tSend stand-in responses chunked in pieces of this size",
                                  [[[NSBundle mainBundle] executablePath] lastPathComponent],
                                  [[[NSBundle mainBundle] infoDictionary] objectForKey:(NSString *)kCFBundleVersionKey],
                                  [[[NSBundle mainBundle] infoDictionary] objectForKey:@"CFBundleGetInfoString"],
@@ -51,19 +254,29 @@ int main(int argc, char *argv[])
             [[NSUserDefaults standardUserDefaults] registerDefaults:[NSDictionary dictionaryWithObject:[[NSFileManager defaultManager] currentDirectoryPath] forKey:@"outPath"]];
         }
 
-        NSLog(@"Parsing WSDL from %@", parserApp.wsdlURL);
+        NSString *benchmarkReport = [[NSUserDefaults standardUserDefaults] stringForKey:@"benchmarkReport"];
+        if (benchmarkReport)
+            [USProfiler start];
 
-        USParser    *parser = [[USParser alloc] initWithURL:parserApp.wsdlURL];
-        USWSDL      *wsdl = [parser parse];
+        int status = 0;
+        // The profiler isn't thread safe, so benchmarked batches run one job at a time
+        if (batchManifest)
+            status = generateBatch(parserApp, batchManifest, benchmarkReport != nil);
+        else if ([[NSUserDefaults standardUserDefaults] integerForKey:@"standInPort"])
+            status = standIn(parserApp, (uint16_t)[[NSUserDefaults standardUserDefaults] integerForKey:@"standInPort"]);
+        else if ([[NSUserDefaults standardUserDefaults] boolForKey:@"watch"]) {
+            USResourceCache *cache = [USResourceCache new];
+            NSArray *inputURLs = nil;
+            generate(parserApp, parserApp.wsdlURL, parserApp.outURL, cache, &inputURLs);
+            watch(parserApp, inputURLs, cache);
+        }
+        else if (!generate(parserApp, parserApp.wsdlURL, parserApp.outURL, nil, NULL))
+            status = 1;
 
-        [parserApp writeDebugInfoForWSDL:wsdl];
+        if (benchmarkReport)
+            [USProfiler writeReportToPath:benchmarkReport];
 
-        NSLog(@"Generating Objective-C code into %@", parserApp.outURL);
-        USWriter *writer = [[USWriter alloc] initWithWSDL:wsdl outputDirectory:parserApp.outURL];
-        [writer write];
-        
         NSLog(@"Finished!");
+        return status;
     }
-    
-    return 0;
 }